@@ -9,6 +9,26 @@ import serial
 import serial.tools.list_ports
 import threading
 import time
+import re
+
+
+# one answer part:  A:<module><index>[@tag],<command>[,parameters]#<result><text>#
+# long answers are sent in several parts, all but the last with result CNT- (see lib/Com/README "Streamed Answers")
+ANSWER_PART = re.compile(r'(A:[^#]*#)(CNT-|OK-|NOK-)([^#]*)#')
+
+
+def collect_answer(buffer):
+    """
+    Join the parts of a streamed answer.
+    Returns the answer as one frame (header, final result, texts of all parts) or None if the final part is missing.
+    """
+    text = ""
+    for match in ANSWER_PART.finditer(buffer):
+        header, result, part = match.groups()
+        text += part
+        if result != "CNT-":
+            return f"{header}{result}{text}#"
+    return None
 
 
 class SerialCommunicator:
@@ -71,10 +91,11 @@ class SerialCommunicator:
                     data = self.serial_port.read(self.serial_port.in_waiting).decode('utf-8')
                     response_buffer += data
 
-                    # Look for a complete frame (ends with '#')
-                    if response_buffer.endswith("#"):
-                        self.app._log_recv(response_buffer.strip())
-                        return response_buffer
+                    # Look for a complete answer (last part with OK- / NOK-)
+                    response = collect_answer(response_buffer)
+                    if response is not None:
+                        self.app._log_recv(response.strip())
+                        return response
             
         except Exception as e:
             self.app._log_recv( f"Error: {str(e)}")
@@ -114,10 +135,11 @@ class SerialCommunicator:
                     data = self.serial_port.read(self.serial_port.in_waiting).decode('utf-8')
                     response_buffer += data
 
-                    # Look for a complete frame (ends with '#')
-                    if response_buffer.endswith("#"):
-                        self.app._log_recv_buffered(response_buffer.strip())
-                        return response_buffer
+                    # Look for a complete answer (last part with OK- / NOK-)
+                    response = collect_answer(response_buffer)
+                    if response is not None:
+                        self.app._log_recv_buffered(response.strip())
+                        return response
             
         except Exception as e:
             self.app._log_recv_buffered( f"Error: {str(e)}")
\ No newline at end of file
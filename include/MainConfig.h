@@ -19,6 +19,12 @@
 #define WAIT_FOR_TERMINAL           0  //[ms]    
 #define BLINK_SEQ_MAIN              {500, 500}
 
+// optional second COM link (i.e. UART1 for a second controller), Serial (USB) stays the main link
+// uncomment to enable
+//#define COM_AUX_SERIAL              Serial2
+#define COM_AUX_BAUDRATE            115200
+#define COM_AUX_MAX_DATA_LENGTH     256     // raw data of binary frames on the aux link (RAM ~3.2KB instead of ~15.7KB)
+
 
 
 ///////////////////////////////////////////
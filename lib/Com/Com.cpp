@@ -36,34 +36,165 @@
 Com com;
 
 
-void Com::begin(HardwareSerial * pPort, int baudRate , uint16_t config, String initMsg){
-    ASSERT(pPort != NULL, F("invalid serial port"));
+Com::Com(const String& name, ComDispatch * pDispatcher, uint16_t maxDataLength) : Dump(name),
+    _pPort(nullptr), _timeBudget_us(COM_LOOP_TIME_BUDGET_US), _binSize(COM_BIN_ENCODED_LENGTH(maxDataLength)), _pRxFrame(nullptr),
+    _readyQueue(COM_RX_QUEUE_SIZE), _tx(2 * maxDataLength + COM_TX_TEXT_RESERVE), _txMinFree(maxDataLength + COM_TX_TEXT_RESERVE),
+    _stats{}, _pDispatcher(pDispatcher)
+{
+    ASSERT(maxDataLength <= COM_FRAME_MAX_DATA_LENGTH, F("COM data buffer too big"));
+    _pBinBuffer = new uint8_t[_binSize];
+    _pFrameData = new uint8_t[COM_RX_QUEUE_SIZE * maxDataLength];
+    ASSERT((_pBinBuffer != nullptr) && (_pFrameData != nullptr), F("could not allocate COM buffers"));
+    for (uint8_t i = 0; i < COM_RX_QUEUE_SIZE; i++) {
+        _frameBusy[i] = false;
+        _frames[i].link = this;
+        _frames[i].data = &_pFrameData[i * maxDataLength];
+        _frames[i].dataSize = maxDataLength;
+    }
+}
+
+Com::~Com() {
+    delete[] _pBinBuffer;
+    delete[] _pFrameData;
+}
+
+void Com::begin(Stream * pPort, String initMsg){
+    ASSERT(pPort != NULL, F("invalid COM port"));
+    ASSERT(_pDispatcher != NULL, F("COM without dispatcher"));
     _pPort = pPort;
-    _pPort->begin(baudRate,config);
-    _pPort->println(initMsg);
+    _pDispatcher->attach(this);
+    _tx.begin(_pPort);
+    _tx.println(initMsg);
     reset();
 }
 
+void Com::begin(HardwareSerial * pPort, int baudRate , uint16_t config, String initMsg){
+    ASSERT(pPort != NULL, F("invalid serial port"));
+    pPort->begin(baudRate,config);
+    begin((Stream *)pPort, initMsg);
+}
+
+String Com::dump(uint32_t now_ms, uint32_t userID) const {
+    String out = _dumpName + " Dump at " + String(now_ms) + " ms:\n";
+    out += "  Bytes Received: " + String(_stats.bytesReceived) + "\n";
+    out += "  Frames Received: " + String(_stats.framesReceived) + "\n";
+    out += "  Frames Dropped: " + String(_stats.framesDropped) + "\n";
+    out += "  Frames Dispatched: " + String(_stats.framesDispatched) + "\n";
+    out += "  TX Bytes Sent: " + String(_tx.bytesSent) + "\n";
+    out += "  Frame Data: " + String(COM_RX_QUEUE_SIZE) + " x " + String(_frames[0].dataSize) + " bytes\n";
+    out += "  TX Queue: " + String(_tx.count()) + " / " + String(_tx.size()) + " bytes (high water " + String(_tx.highWater) + ")\n";
+    out += "  TX Backpressure: " + String(_stats.txBackpressure) + "\n";
+    out += "  TX Truncated Answers: " + String(_stats.txTruncated) + "\n";
+    out += "  TX Dropped Bytes: " + String(_tx.droppedBytes) + "\n";
+    return out;
+}
+
+void Com::setTimeBudget(uint32_t budget_us) {
+    ASSERT(budget_us > 0, F("time budget of zero would block COM"));
+    _timeBudget_us = budget_us;
+}
+
 void Com::addModule(ComModule* module) {
     ASSERT(module != nullptr, "Invalid module pointer");
-    _dispatcher.registerModule(module);
+    if (_pDispatcher->registerModule(module) == false) {
+        ASSERT(false, F("COM module not registered (id or index out of range)"));
+    }
 }
 
 
 void Com::loop(uint32_t now){
+    // drain all available bytes in one call, but never longer than the time budget
+    // so that the other tasks of the loop (i.e. stripe.service()) are not starved
+    if (_pPort == nullptr) return;      // link not started
+
+    uint32_t start = micros();
+    ComFrame * pFrame = nullptr;
+
+    _tx.drain();
+
+    // answers of background commands (finished by comWorker on core0)
+    while (_tx.free() >= _txMinFree) {
+        bool res = false;
+        if ((pFrame = comWorker.takeCompleted(this, res)) == nullptr) break;
+        answerDeferred(res, pFrame);
+        _tx.drain();
+    }
+
+    do {
+        // process received frames first (FIFO) .. but only if the answer will find space in the TX queue
+        if (_readyQueue.isEmpty() == false) {
+            if (_tx.free() < _txMinFree) {
+                _stats.txBackpressure++;
+                break;
+            }
+            _readyQueue.pop(&pFrame);
+            frameDone(pFrame);
+            _tx.drain();
+            continue;
+        }
+
+        // all frames of queue are busy (deferred) .. leave the bytes in the port buffer
+        if ((_pRxFrame == nullptr) && ((_pRxFrame = allocFrame()) == nullptr)) {
+            break;
+        }
+        if (_pPort->available() <= 0) {
+            break;
+        }
+        parseByte((uint8_t)_pPort->read());
+        _stats.bytesReceived++;
+        if (_state == FRAME_DONE) {
+            _stats.framesReceived++;
+            _readyQueue.push(_pRxFrame);
+            _pRxFrame = nullptr;
+            _state = WAIT;
+        }
+    } while ((micros() - start) < _timeBudget_us);
+
+    // module loops (timeouts) once per cycle, not once per link
+    if (_pDispatcher->isOwner(this) == true) {
+        _pDispatcher->loop(now);
+    }
+}
+
+ComFrame * Com::allocFrame(){
+    for (uint8_t i = 0; i < COM_RX_QUEUE_SIZE; i++) {
+        if (_frameBusy[i] == false) {
+            _frameBusy[i] = true;
+            _frames[i].reset();
+            return &_frames[i];
+        }
+    }
+    return nullptr;
+}
+
+void Com::freeFrame(ComFrame * pFrame){
+    for (uint8_t i = 0; i < COM_RX_QUEUE_SIZE; i++) {
+        if (&_frames[i] == pFrame) {
+            _frameBusy[i] = false;
+            return;
+        }
+    }
+    LOG(F("COM: frame does not belong to this queue"));
+}
+
+void Com::parseByte(uint8_t byte){
     switch(_state){
-        case WAIT:          doWaiting();        break;
-        case START_FRAME:   getStartOfFrame();  break;
-        case MODULE:        getModule();        break;
-        case COMMAND:       getCommand();       break;
-        case PAR1:          getPar0();          break;
-        case PAR2:          getPar1();          break;
-        case PAR3:          getPar2();          break;
-        case PAR4:          getPar3();          break;
-        case STR_START:     getStrStart();      break;
-        case STR_DATA:      getStrData();       break;
-        case STR_END:       getStrEnd();        break;
-        case FRAME_DONE:    frameDone();        break;
+        case WAIT:          doWaiting(byte);        break;
+        case START_FRAME:   getStartOfFrame(byte);  break;
+        case MODULE:        getModule(byte);        break;
+        case INDEX:         getIndex(byte);         break;
+        case MODULE_END:    getModuleEnd(byte);     break;
+        case TAG:           getTag(byte);           break;
+        case COMMAND:       getCommand(byte);       break;
+        case PAR1:          getPar0(byte);          break;
+        case PAR2:          getPar1(byte);          break;
+        case PAR3:          getPar2(byte);          break;
+        case PAR4:          getPar3(byte);          break;
+        case STR_START:     getStrStart(byte);      break;
+        case STR_DATA:      getStrData(byte);       break;
+        case STR_END:       getStrEnd(byte);        break;
+        case BIN_DATA:      getBinData(byte);       break;
+        case FRAME_DONE:    break;  // frame will be queued by loop before next byte is parsed
 
         default:
             LOG(F("unknown decode state"));           
@@ -72,31 +203,27 @@ void Com::loop(uint32_t now){
 
 void Com::reset(){
     _endFound = false;
-    _field = "";
+    _field.clear();
     _maxFieldLength = COM_FRAME_MAX_COMMAND_LENGTH;
     _dataReceived = 0;
-    _frame.reset();
+    _binLength = 0;
+    if (_pRxFrame != nullptr) {
+        _pRxFrame->reset();
+    }
     _state = WAIT;
 }
 
-void Com::doWaiting(){
-    uint8_t buffer;
-    if (getByte(&buffer) == false)  {
-        return;             
-    }
-    
-    if (buffer == COM_FRAME_START1) {
+void Com::doWaiting(uint8_t byte){
+    if (byte == COM_FRAME_START1) {
         _state=START_FRAME; 
-    } 
+    } else if (byte == COM_BIN_FRAME_START) {
+        _binLength = 0;
+        _state=BIN_DATA;
+    }
 }
 
-void Com::getStartOfFrame(){
-    uint8_t buffer;
-    if (getByte(&buffer) == false)  {
-        return;            
-    } 
-    
-    if (buffer == COM_FRAME_START2) {
+void Com::getStartOfFrame(uint8_t byte){
+    if (byte == COM_FRAME_START2) {
         _endFound = false;
         _state = MODULE;
         return;
@@ -104,214 +231,275 @@ void Com::getStartOfFrame(){
     reset();
 }
 
-void Com::getModule(){
-    uint8_t buffer[3];
-    if (getBytes(3,buffer)== false)   {
+void Com::getModule(uint8_t byte){
+    _pRxFrame->module = byte;
+    _state = INDEX;
+}
+
+void Com::getIndex(uint8_t byte){
+    _pRxFrame->index = convertDezCharToInt(byte);
+    _state = MODULE_END;
+}
+
+void Com::getModuleEnd(uint8_t byte){
+    if (byte == COM_FRAME_TAG_START) {
+        _state = TAG;
+        _field.clear();
+        _maxFieldLength = COM_FRAME_MAX_PARAMETER_LENGTH;
         return;
     }
-    if (buffer[2] != COM_FRAME_SEP)   {
+    if (byte != COM_FRAME_SEP)   {
         reset(); 
         return;   
     }      
-    _frame.module = buffer[0];
-    _frame.index =  convertDezCharToInt(buffer[1]);
     _state = COMMAND;
-    _field = "";
+    _field.clear();
+    _maxFieldLength = COM_FRAME_MAX_COMMAND_LENGTH;
+}
+
+void Com::getTag(uint8_t byte){
+    if (collectField(byte) == false)    {
+        return;            
+    }
+    if (_endFound == true){
+        reset();        // command is missing
+        return;
+    }
+    _pRxFrame->tagged = true;
+    _pRxFrame->tag = (uint16_t)convertStrToInt(_field.c_str());
+    _state = COMMAND;
+    _field.clear();
     _maxFieldLength = COM_FRAME_MAX_COMMAND_LENGTH;
 }
 
 
-void Com::getCommand(){
-    if (collectField() == false)    {
+void Com::getCommand(uint8_t byte){
+    if (collectField(byte) == false)    {
         return;            
     }
-    _frame.command = _field;
+    _pRxFrame->command = _field;
     if (_endFound == true){
         _state = FRAME_DONE;
     } else {
         _state = PAR1;
-        _frame.withPar=true;
-        _field = "";
+        _pRxFrame->withPar=true;
+        _field.clear();
         _maxFieldLength = COM_FRAME_MAX_PARAMETER_LENGTH;
     }
 }
 
 
-void Com::getPar0(){
-    if (collectField() == false)    {
+void Com::getPar0(uint8_t byte){
+    if (collectField(byte) == false)    {
         return;            
     }
-    _frame.cfg.par0.uint32 = convertStrToInt(_field);
+    _pRxFrame->cfg.par0.uint32 = convertStrToInt(_field.c_str());
     if (_endFound == true){
         _state = FRAME_DONE;
     } else {
         _state = PAR2;
-        _field = "";
+        _field.clear();
         _maxFieldLength = COM_FRAME_MAX_PARAMETER_LENGTH;
     }
 }
 
-void Com::getPar1(){
-    if (collectField() == false)    {
+void Com::getPar1(uint8_t byte){
+    if (collectField(byte) == false)    {
         return;            
     }
-    _frame.cfg.par1.uint32 = convertStrToInt(_field);
+    _pRxFrame->cfg.par1.uint32 = convertStrToInt(_field.c_str());
     if (_endFound == true){
         _state = FRAME_DONE;
     } else {
         _state = PAR3;
-        _field = "";
+        _field.clear();
         _maxFieldLength = COM_FRAME_MAX_PARAMETER_LENGTH;
     }
 }
 
-void Com::getPar2(){
-    if (collectField() == false)    {
+void Com::getPar2(uint8_t byte){
+    if (collectField(byte) == false)    {
         return;            
     }
-    _frame.cfg.par2.uint32 = convertStrToInt(_field);
+    _pRxFrame->cfg.par2.uint32 = convertStrToInt(_field.c_str());
     if (_endFound == true){
         _state = FRAME_DONE;
     } else {
         _state = PAR4;
-        _field = "";
+        _field.clear();
         _maxFieldLength = COM_FRAME_MAX_PARAMETER_LENGTH;
     }
 }
 
-void Com::getPar3(){
-    if (collectField() == false)    {
+void Com::getPar3(uint8_t byte){
+    if (collectField(byte) == false)    {
         return;            
     }
-    _frame.cfg.par3.uint32 = convertStrToInt(_field);
-    _field = "";
+    _pRxFrame->cfg.par3.uint32 = convertStrToInt(_field.c_str());
+    _field.clear();
     if (_endFound == true){
         _state = FRAME_DONE;
     } else {
         _state = STR_START;
-        _field = "";
+        _field.clear();
     }
 }
 
-void Com::getStrStart(){
-    uint8_t buffer;
-    if (getByte(&buffer) == false)  {
-        return;            
-    } 
-
-    if (buffer == COM_FRAME_TEXT_QUOTES){
+void Com::getStrStart(uint8_t byte){
+    if (byte == COM_FRAME_TEXT_QUOTES){
         _state = STR_DATA;
-        _frame.cfg.str = "";
-    } else if (buffer == COM_FRAME_END) {
+        _pRxFrame->cfg.str.clear();
+    } else if (byte == COM_FRAME_END) {
         _state = FRAME_DONE;
     } else {
         reset();       
     }
 }
 
-void Com::getStrData(){
-    uint8_t buffer;
-    if (getByte(&buffer) == false)  {
-        return;            
-    } 
-
-    if (buffer == COM_FRAME_TEXT_QUOTES){
+void Com::getStrData(uint8_t byte){
+    if (byte == COM_FRAME_TEXT_QUOTES){
         _state = STR_END;
     } else {
-        _frame.cfg.str+=(char)buffer;
-        if (_frame.cfg.str.length() > COM_FRAME_MAX_STR_LENGTH){
+        if (_pRxFrame->cfg.str.append((char)byte) == false){
             reset();       
         }
     }
 }
 
-void Com::getStrEnd(){
-    uint8_t buffer;
-    if (getByte(&buffer) == false)  {
-        return;            
-    } 
-
-    if (buffer == COM_FRAME_END) {
+void Com::getStrEnd(uint8_t byte){
+    if (byte == COM_FRAME_END) {
         _state = FRAME_DONE;
     } else {
         reset();       
     }
 }
 
+void Com::getBinData(uint8_t byte){
+    if (byte == COM_BIN_FRAME_DELIMITER) {
+        size_t length = cobsDecode(_pBinBuffer, _binLength, _pBinBuffer);
+        if (comBinaryToFrame(_pBinBuffer, length, _pRxFrame) == true) {
+            _state = FRAME_DONE;
+        } else {
+            LOG(F("binary frame dropped (COBS/CRC/length)"));
+            _stats.framesDropped++;
+            reset();
+        }
+        return;
+    }
 
-void Com::frameDone(){
-    // frame ready for further processing
-    bool res = _dispatcher.dispatchFrame(&_frame);
-    sendAnswer(res,&_frame);
-
-    // frame processed delete all data now
-    reset();  // will free pBuffer if not taken over from application (_frame.pBuffer=NULL)
+    if (_binLength >= _binSize) {
+        reset();
+        return;
+    }
+    _pBinBuffer[_binLength++] = byte;
 }
 
-void Com::sendAnswer(bool res,ComFrame * pFrame){
-    String out;
 
-    out = COM_FRAME_ANSWER_START;
-    out += pFrame->module;
-    out += String(pFrame->index);
-    out += COM_FRAME_SEP;
-    out += pFrame->command;
-    if (pFrame->withPar == true){
-        out += COM_FRAME_SEP;
-        out += "0x" + String(pFrame->cfg.par0.uint32,HEX);
-        out += COM_FRAME_SEP;
-        out += "0x" + String(pFrame->cfg.par1.uint32,HEX);
-        out += COM_FRAME_SEP;
-        out += "0x" + String(pFrame->cfg.par2.uint32,HEX);
-        out += COM_FRAME_SEP;
-        out += "0x" + String(pFrame->cfg.par3.uint32,HEX);
-        out += COM_FRAME_SEP;
-        out += COM_FRAME_TEXT_QUOTES;
-        out += String(pFrame->cfg.str);
-        out += COM_FRAME_TEXT_QUOTES;
-    }
-    if (res == true){
-        out+=COM_FRAME_END;
-        out+="OK-";
-        out+=pFrame->res;
-        out+=COM_FRAME_END;
-    } else {
-        out+=COM_FRAME_END;
-        out+="NOK-";
-        out+=pFrame->res;
-        out+=COM_FRAME_END;
+void Com::frameDone(ComFrame * pFrame){
+    // frame ready for further processing
+    _answer.begin(this, pFrame);
+    bool res = _pDispatcher->dispatchFrame(pFrame);
+    _stats.framesDispatched++;
+    if (pFrame->deferred == true) {
+        // handler will answer later with answerDeferred() .. frame stays reserved until then
+        _answer.flush();
+        _answer.end();
+        comWorker.start(pFrame);        // background command: core0 takes the frame only now
+        return;
     }
-    _pPort->print(out);
-}
+    sendAnswer(res,pFrame);
+    _answer.end();
 
+    // frame processed, give it back to the queue
+    freeFrame(pFrame);
+}
 
+void Com::answerDeferred(bool res,ComFrame * pFrame){
+    ASSERT(pFrame->deferred == true, F("COM: answer for a frame that is not deferred"));
+    ASSERT(pFrame->link == this, F("COM: deferred answer on wrong link"));
+    sendAnswer(res,pFrame);
+    freeFrame(pFrame);
+}
 
-bool Com::getByte(uint8_t * pBuffer){
-    uint8_t value;
-    if (_pPort->available() >= 1) {
-        value = _pPort->read();
-        *pBuffer= value;
-        return true;
+void Com::sendAnswer(bool res,ComFrame * pFrame){
+    // bytes of a streamed answer that are not sent yet are part of the final answer
+    size_t length = _answer.pendingLength(pFrame) + pFrame->res.length() + ((pFrame->binary == true) ? pFrame->dataLength : 0);
+    if ((_answer.truncated(pFrame) == false) && (reserveAnswer(length) == true)) {
+        writeAnswer(pFrame, true, res, _answer.pending(pFrame), _answer.pendingLength(pFrame));
+        return;
     }
-    return false;    
+
+    // no room for the answer or a part of the stream was dropped .. the host gets at least the final marker with the reason
+    pFrame->res = F("Error: answer truncated (TX queue full)");
+    pFrame->dataLength = 0;
+    writeAnswer(pFrame, true, false, nullptr, 0);
 }
 
-bool Com::getBytes(uint32_t count,uint8_t * pBuffer){
-    uint8_t value;
-    if (_pPort->available() >= count) {
-        for(int i=0;i < count; i++){
-            value = _pPort->read();
-            pBuffer[i] = value;
+// room for an answer with length bytes of text / data (+ header) .. waits at most COM_TX_WAIT_BUDGET_US for the port
+bool Com::reserveAnswer(size_t length){
+    if (_tx.reserve(length + COM_TX_TEXT_RESERVE, COM_TX_WAIT_BUDGET_US) == true) return true;
+    _stats.txTruncated++;
+    return false;
+}
+
+// last == false: intermediate part of a streamed answer (continuation marker, pFrame->res not sent)
+void Com::writeAnswer(ComFrame * pFrame, bool last, bool res, const char * pText, size_t textLength){
+    if (pFrame->binary == true) {
+        uint8_t resultFlags = (last == false) ? COM_BIN_FLAG_CONTINUED : ((res == true) ? COM_BIN_FLAG_RESULT_OK : 0);
+        if (last == true) {
+            comBinaryWriteAnswer(&_tx, resultFlags, pFrame, pText, textLength, pFrame->res.c_str(), pFrame->res.length());
+        } else {
+            comBinaryWriteAnswer(&_tx, resultFlags, pFrame, pText, textLength, nullptr, 0);
         }
-        return true;
+        return;
+    }
+
+    // print part by part .. building one big String would cost several heap allocations per frame
+    _tx.print(COM_FRAME_ANSWER_START);
+    _tx.print(pFrame->module);
+    _tx.print(pFrame->index);
+    if (pFrame->tagged == true){
+        _tx.print(COM_FRAME_TAG_START);
+        _tx.print(pFrame->tag);
+    }
+    _tx.print(COM_FRAME_SEP);
+    _tx.print(pFrame->command.c_str());
+    if (pFrame->withPar == true){
+        _tx.print(COM_FRAME_SEP);
+        _tx.print("0x");
+        _tx.print(pFrame->cfg.par0.uint32,HEX);
+        _tx.print(COM_FRAME_SEP);
+        _tx.print("0x");
+        _tx.print(pFrame->cfg.par1.uint32,HEX);
+        _tx.print(COM_FRAME_SEP);
+        _tx.print("0x");
+        _tx.print(pFrame->cfg.par2.uint32,HEX);
+        _tx.print(COM_FRAME_SEP);
+        _tx.print("0x");
+        _tx.print(pFrame->cfg.par3.uint32,HEX);
+        _tx.print(COM_FRAME_SEP);
+        _tx.print(COM_FRAME_TEXT_QUOTES);
+        _tx.print(pFrame->cfg.str.c_str());
+        _tx.print(COM_FRAME_TEXT_QUOTES);
+    }
+    _tx.print(COM_FRAME_END);
+    if (last == false) {
+        _tx.print(COM_FRAME_RESULT_CONTINUE);
+    } else {
+        _tx.print((res == true) ? COM_FRAME_RESULT_OK : COM_FRAME_RESULT_NOK);
     }
-    return false;    
+    if (textLength > 0) {
+        _tx.write((const uint8_t *)pText, textLength);
+    }
+    if (last == true) {
+        _tx.print(pFrame->res);
+    }
+    _tx.print(COM_FRAME_END);
 }
 
-bool Com::collectField(){
-    uint8_t __byte;
-    if (getByte(&__byte)== false) { return false;}
 
+
+bool Com::collectField(uint8_t __byte){
     if (__byte == COM_FRAME_END){
         _endFound = true;
         return true;
@@ -322,7 +510,7 @@ bool Com::collectField(){
         return true;
     }
 
-    _field += (char)__byte;
+    _field.append((char)__byte);
     if (_field.length() >= _maxFieldLength) {reset();  return false;}
 
     return false;
@@ -29,51 +29,127 @@
 #include <Arduino.h>
 #include <ComFrame.hpp>
 #include <ComDispatch.hpp>
+#include <ComBinary.hpp>
+#include <ComTxQueue.hpp>
+#include <ComAnswerStream.hpp>
+#include <ComWorker.hpp>
+#include <RingBuffer.hpp>
+#include <Debug.hpp>
 
-class Com
+// max time [us] one call of Com::loop may spend on parsing received bytes (incl. dispatch of a completed frame)
+#ifndef COM_LOOP_TIME_BUDGET_US
+#define COM_LOOP_TIME_BUDGET_US     500
+#endif
+
+// number of frames that can be received in advance (pipelined requests) or wait for a deferred answer
+#ifndef COM_RX_QUEUE_SIZE
+#define COM_RX_QUEUE_SIZE           4
+#endif
+
+// answers are queued and sent without blocking the loop .. the TX queue of a link holds two answers
+// with a full data buffer (2 * maxDataLength + COM_TX_TEXT_RESERVE)
+// a received frame is only dispatched if one of them fits (maxDataLength + COM_TX_TEXT_RESERVE, backpressure)
+#ifndef COM_TX_TEXT_RESERVE
+#define COM_TX_TEXT_RESERVE         512
+#endif
+
+// max time [us] one answer (or one part of a streamed answer) may wait for the port if it does not fit into the TX queue
+// after that (or at once if the port takes nothing, i.e. host closed the USB port) the answer is cut with an error
+#ifndef COM_TX_WAIT_BUDGET_US
+#define COM_TX_WAIT_BUDGET_US       2000
+#endif
+
+struct ComStats {
+    uint32_t bytesReceived;
+    uint32_t framesReceived;
+    uint32_t framesDropped;         // binary frames with crc/length errors
+    uint32_t framesDispatched;
+    uint32_t txBackpressure;        // loops where dispatch waited for space in the TX queue
+    uint32_t txTruncated;           // answers cut, because the port did not take the bytes in time
+};
+
+/*
+    one COM link .. runs on any Stream (USB CDC, UART, ..)
+
+    several links can be used at the same time (i.e. USB for the PC app and a UART for a second controller),
+    each with its own name (dump) and its own RX/TX queues. By default all links share the module table comDispatch,
+    so a module added once can be reached on every link.
+
+    RAM of a link is set by maxDataLength (raw data of binary frames, max COM_FRAME_MAX_DATA_LENGTH):
+    COM_RX_QUEUE_SIZE frame buffers + COBS buffer + TX queue, about 7 * maxDataLength + 1.4KB
+    (2048: ~15.7KB, 256: ~3.2KB) .. give a link without raw file transfers a small buffer
+*/
+class Com : public Dump
 {
 public:
-	Com(){}
-	~Com() = default;
+	Com(const String& name = "Com", ComDispatch * pDispatcher = &comDispatch, uint16_t maxDataLength = COM_FRAME_MAX_DATA_LENGTH);
+	~Com();
 
+    void begin(Stream * pPort, String initMsg="Pico COM module V1.1 ready");
     void begin(HardwareSerial * pPort, int baudRate = 115200, uint16_t config = SERIAL_8N1 ,String initMsg="Pico COM module V1.1 ready");
-    void addModule(ComModule* module);
+    void addModule(ComModule* module);      // registered in the (shared) dispatcher
 
     void loop(uint32_t now);
     void reset();
+    void setTimeBudget(uint32_t budget_us);
     void sendAnswer(bool res,ComFrame * pFrame);
+    void answerDeferred(bool res,ComFrame * pFrame);     // answer a frame the handler has marked as deferred
+
+    const ComStats & getStats() const  { return _stats; }
+    String dump(uint32_t now_ms, uint32_t userID) const override;
 
 private:
-    enum ComState  {WAIT,START_FRAME,MODULE,INDEX,COMMAND,PAR1,PAR2,PAR3,PAR4,STR_START,STR_DATA,STR_END,FRAME_DONE};
-    HardwareSerial * _pPort;
+    friend class ComAnswerStream;
+
+    enum ComState  {WAIT,START_FRAME,MODULE,INDEX,MODULE_END,TAG,COMMAND,PAR1,PAR2,PAR3,PAR4,STR_START,STR_DATA,STR_END,BIN_DATA,FRAME_DONE};
+    Stream * _pPort;
     ComState _state; 
 
-    void doWaiting();
-    void getStartOfFrame();
-    void getModule();
-    void getIndex();
-    void getCommand();
-    void getPar0();
-    void getPar1();
-    void getPar2();
-    void getPar3();
-    void getStrStart();
-    void getStrData();
-    void getStrEnd();
-    void frameDone();
-
-    bool getByte(uint8_t * pBuffer);
-    bool getBytes(uint32_t count,uint8_t * pBuffer);
-    bool collectField();
+    void parseByte(uint8_t byte);
+    void doWaiting(uint8_t byte);
+    void getStartOfFrame(uint8_t byte);
+    void getModule(uint8_t byte);
+    void getIndex(uint8_t byte);
+    void getModuleEnd(uint8_t byte);
+    void getTag(uint8_t byte);
+    void getCommand(uint8_t byte);
+    void getPar0(uint8_t byte);
+    void getPar1(uint8_t byte);
+    void getPar2(uint8_t byte);
+    void getPar3(uint8_t byte);
+    void getStrStart(uint8_t byte);
+    void getStrData(uint8_t byte);
+    void getStrEnd(uint8_t byte);
+    void getBinData(uint8_t byte);
+    void frameDone(ComFrame * pFrame);
+    bool reserveAnswer(size_t textLength);
+    void writeAnswer(ComFrame * pFrame, bool last, bool res, const char * pText, size_t textLength);
+
+    ComFrame * allocFrame();
+    void freeFrame(ComFrame * pFrame);
+
+    bool collectField(uint8_t byte);
     
-    uint8_t     _byte;
-    String      _field;
+    uint32_t    _timeBudget_us;
+    FixedString<COM_FRAME_MAX_COMMAND_LENGTH> _field;   // inline buffer for command & parameter fields
     uint32_t    _maxFieldLength;
     uint32_t    _dataReceived;
     bool        _endFound;
 
-    ComFrame    _frame;
-    ComDispatch _dispatcher;
+    uint8_t *   _pBinBuffer;                    // COBS block of a binary frame (decoded in place)
+    uint32_t    _binSize;
+    uint32_t    _binLength;
+
+    ComFrame    _frames[COM_RX_QUEUE_SIZE];     // frame pool .. receiving, waiting for dispatch or deferred
+    uint8_t *   _pFrameData;                    // data buffers of the frame pool (COM_RX_QUEUE_SIZE * maxDataLength)
+    bool        _frameBusy[COM_RX_QUEUE_SIZE];
+    ComFrame *  _pRxFrame;                      // frame the parser is filling right now
+    RingBuffer<ComFrame *> _readyQueue;         // completely received frames in order of arrival
+    ComTxQueue  _tx;
+    uint32_t    _txMinFree;
+    ComAnswerStream _answer;
+    ComStats    _stats;
+    ComDispatch * _pDispatcher;
 };
 
 
@@ -0,0 +1,77 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 MonkeyCodeMen@GitHub
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * provided to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include <ComAnswerStream.hpp>
+#include <Com.hpp>
+
+void ComAnswerStream::begin(Com * pCom, ComFrame * pFrame) {
+    _pCom   = pCom;
+    _pFrame = pFrame;
+    _length = 0;
+    _truncated = false;
+    pFrame->out = this;
+}
+
+void ComAnswerStream::end() {
+    if (_pFrame != nullptr) {
+        _pFrame->out = nullptr;
+    }
+    _pFrame = nullptr;
+    _length = 0;
+    _truncated = false;
+}
+
+size_t ComAnswerStream::write(uint8_t value) {
+    return write(&value, 1);
+}
+
+size_t ComAnswerStream::write(const uint8_t * pBuffer, size_t size) {
+    if ((_pFrame == nullptr) || (_truncated == true)) return 0;
+
+    size_t written = 0;
+    while (written < size) {
+        if (_length == COM_ANSWER_STREAM_CHUNK_SIZE) {
+            flush();
+            if (_truncated == true) break;
+        }
+        size_t part = min(size - written, COM_ANSWER_STREAM_CHUNK_SIZE - _length);
+        memcpy(&_buffer[_length], &pBuffer[written], part);
+        _length += part;
+        written += part;
+    }
+    return written;
+}
+
+void ComAnswerStream::flush() {
+    if ((_pFrame == nullptr) || (_length == 0)) return;
+    if ((_truncated == false) && (_pCom->reserveAnswer(_length) == true)) {
+        _pCom->writeAnswer(_pFrame, false, false, _buffer, _length);
+        parts++;
+    } else {
+        _truncated = true;          // port too slow .. drop the rest, the final answer reports it
+    }
+    _length = 0;
+}
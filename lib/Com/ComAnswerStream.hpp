@@ -0,0 +1,79 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 MonkeyCodeMen@GitHub
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * provided to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#pragma once
+#include <Arduino.h>
+#include <ComFrame.hpp>
+
+// size of one part of a streamed answer
+#ifndef COM_ANSWER_STREAM_CHUNK_SIZE
+#define COM_ANSWER_STREAM_CHUNK_SIZE    200
+#endif
+
+class Com;
+
+/*
+    sink for long answers (lists, dumps ..)
+
+    during dispatch a command handler can print its answer to pFrame->out instead of
+    collecting it in pFrame->res. Every time COM_ANSWER_STREAM_CHUNK_SIZE bytes are collected,
+    they are sent as intermediate answer with the continuation marker (CNT- / COM_BIN_FLAG_CONTINUED).
+    the rest is sent together with pFrame->res in the final answer (OK- / NOK-).
+
+    ==> RAM usage does not depend on the length of the answer
+    an answer that fits into one chunk is sent exactly like a pFrame->res answer
+
+    if the port does not make room for a part in time (see COM_TX_WAIT_BUDGET_US), the rest of the answer
+    is dropped (write returns 0) and the final answer is a NOK with the reason
+*/
+class ComAnswerStream : public Print {
+public:
+    ComAnswerStream() : parts(0), _pCom(nullptr), _pFrame(nullptr), _length(0), _truncated(false) {}
+    ~ComAnswerStream() = default;
+
+    void begin(Com * pCom, ComFrame * pFrame);
+    void flush() override;              // send collected bytes as intermediate answer
+    void end();
+
+    size_t write(uint8_t value) override;
+    size_t write(const uint8_t * pBuffer, size_t size) override;
+    using Print::write;
+
+    // collected bytes that are not sent yet (only for the frame the stream is bound to)
+    const char * pending(const ComFrame * pFrame) const  { return (pFrame == _pFrame) ? _buffer : nullptr; }
+    size_t pendingLength(const ComFrame * pFrame) const  { return (pFrame == _pFrame) ? _length : 0;       }
+    bool truncated(const ComFrame * pFrame) const        { return (pFrame == _pFrame) && _truncated;       }
+
+    // statistics
+    uint32_t parts;                     // number of intermediate answers sent
+
+private:
+    Com *      _pCom;
+    ComFrame * _pFrame;
+    size_t     _length;
+    bool       _truncated;
+    char       _buffer[COM_ANSWER_STREAM_CHUNK_SIZE];
+};
@@ -0,0 +1,221 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 MonkeyCodeMen@GitHub
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * provided to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include <ComBinary.hpp>
+#include <helper.h>
+
+static inline uint16_t _getUint16(const uint8_t * p) { return (uint16_t)p[0] | ((uint16_t)p[1] << 8); }
+static inline uint32_t _getUint32(const uint8_t * p) { return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+
+size_t cobsDecode(const uint8_t * pIn, size_t length, uint8_t * pOut) {
+    size_t read  = 0;
+    size_t write = 0;
+
+    while (read < length) {
+        uint8_t code = pIn[read++];
+        if (code == 0) {
+            return 0;           // delimiter inside of block
+        }
+        for (uint8_t i = 1; i < code; i++) {
+            if (read >= length) {
+                return 0;       // block shorter than announced
+            }
+            if (pIn[read] == 0) {
+                return 0;
+            }
+            pOut[write++] = pIn[read++];
+        }
+        if ((code != 0xFF) && (read < length)) {
+            pOut[write++] = 0;
+        }
+    }
+    return write;
+}
+
+
+bool comBinaryToFrame(const uint8_t * pPayload, size_t length, ComFrame * pFrame) {
+    if (length < COM_BIN_HEADER_LENGTH + COM_BIN_CRC_LENGTH) {
+        return false;
+    }
+
+    uint16_t payloadLength = _getUint16(&pPayload[4]);
+    if ((size_t)payloadLength + COM_BIN_CRC_LENGTH != length) {
+        return false;
+    }
+
+    uint16_t crc = _getUint16(&pPayload[payloadLength]);
+    if (crc16(pPayload, payloadLength) != crc) {
+        return false;
+    }
+
+    uint8_t  cmdLength = pPayload[6];
+    uint16_t strLength = _getUint16(&pPayload[7]);
+    uint16_t resLength = _getUint16(&pPayload[9]);
+    size_t   textEnd   = COM_BIN_HEADER_LENGTH + cmdLength + strLength;
+    uint16_t dataLength = 0;
+    if (pPayload[3] & COM_BIN_FLAG_DATA) {
+        if (textEnd + COM_BIN_DATA_LENGTH_SIZE > payloadLength) {
+            return false;
+        }
+        dataLength = _getUint16(&pPayload[textEnd]);
+        textEnd += COM_BIN_DATA_LENGTH_SIZE;
+    }
+    if ((pPayload[0] != COM_BIN_TYPE_REQUEST)
+        || (cmdLength > COM_FRAME_MAX_COMMAND_LENGTH)
+        || (strLength > COM_FRAME_MAX_STR_LENGTH)
+        || (dataLength > pFrame->dataSize)
+        || (resLength != 0)
+        || (textEnd + dataLength != payloadLength)) {
+        return false;
+    }
+
+    const char * pText = (const char *) &pPayload[COM_BIN_HEADER_LENGTH];
+
+    pFrame->module  = pPayload[1];
+    pFrame->index   = pPayload[2];
+    pFrame->withPar = (pPayload[3] & COM_BIN_FLAG_WITH_PAR) ? true : false;
+    pFrame->tagged  = (pPayload[3] & COM_BIN_FLAG_TAGGED) ? true : false;
+    pFrame->tag     = _getUint16(&pPayload[27]);
+    pFrame->cfg.par0.uint32 = _getUint32(&pPayload[11]);
+    pFrame->cfg.par1.uint32 = _getUint32(&pPayload[15]);
+    pFrame->cfg.par2.uint32 = _getUint32(&pPayload[19]);
+    pFrame->cfg.par3.uint32 = _getUint32(&pPayload[23]);
+    pFrame->command.assign(pText, cmdLength);
+    pFrame->cfg.str.assign(pText + cmdLength, strLength);
+    pFrame->dataLength = dataLength;
+    memcpy(pFrame->data, &pPayload[textEnd], dataLength);
+    pFrame->binary  = true;
+    return true;
+}
+
+
+void ComBinaryWriter::begin() {
+    _count = 0;
+    _crc   = 0xFFFF;
+    _pOut->write((uint8_t)COM_BIN_FRAME_START);
+}
+
+void ComBinaryWriter::put(uint8_t value) {
+    _crc = crc16(&value, 1, _crc);
+    _stuff(value);
+}
+
+void ComBinaryWriter::put(const uint8_t * p, size_t length) {
+    while (length--) {
+        put(*p++);
+    }
+}
+
+void ComBinaryWriter::putUint16(uint16_t value) {
+    put((uint8_t)(value & 0xFF));
+    put((uint8_t)(value >> 8));
+}
+
+void ComBinaryWriter::putUint32(uint32_t value) {
+    putUint16((uint16_t)(value & 0xFFFF));
+    putUint16((uint16_t)(value >> 16));
+}
+
+void ComBinaryWriter::end() {
+    uint16_t crc = _crc;
+    _stuff((uint8_t)(crc & 0xFF));
+    _stuff((uint8_t)(crc >> 8));
+    _flushBlock();
+    _pOut->write((uint8_t)COM_BIN_FRAME_DELIMITER);
+}
+
+void ComBinaryWriter::_stuff(uint8_t value) {
+    if (value == 0) {
+        _flushBlock();
+        return;
+    }
+    _block[_count++] = value;
+    if (_count == sizeof(_block)) {
+        // full block without zero .. code 0xFF has no implicit zero
+        _pOut->write((uint8_t)0xFF);
+        _pOut->write(_block, _count);
+        _count = 0;
+    }
+}
+
+void ComBinaryWriter::_flushBlock() {
+    _pOut->write((uint8_t)(_count + 1));
+    if (_count > 0) {
+        _pOut->write(_block, _count);
+    }
+    _count = 0;
+}
+
+
+void comBinaryWriteAnswer(Print * pOut, bool res, ComFrame * pFrame) {
+    comBinaryWriteAnswer(pOut, (res == true) ? COM_BIN_FLAG_RESULT_OK : 0, pFrame, nullptr, 0, pFrame->res.c_str(), pFrame->res.length());
+}
+
+void comBinaryWriteAnswer(Print * pOut, uint8_t resultFlags, ComFrame * pFrame,
+                          const char * pText, size_t textLength, const char * pRes, size_t resLength) {
+    uint8_t  cmdLength = pFrame->command.length();
+    uint16_t strLength = (pFrame->withPar == true) ? pFrame->cfg.str.length() : 0;
+    uint8_t  flags     = resultFlags;
+
+    // raw data only with the final part of an answer
+    uint16_t dataLength = ((resultFlags & COM_BIN_FLAG_CONTINUED) == 0) ? pFrame->dataLength : 0;
+    size_t   dataField  = (dataLength > 0) ? COM_BIN_DATA_LENGTH_SIZE + dataLength : 0;
+    if (dataLength > 0) flags |= COM_BIN_FLAG_DATA;
+
+    // length field is 16 bit .. cut oversized results
+    size_t maxResult = 0xFFFF - COM_BIN_HEADER_LENGTH - cmdLength - strLength - dataField;
+    if (textLength > maxResult)             textLength = maxResult;
+    if (textLength + resLength > maxResult) resLength  = maxResult - textLength;
+
+    if (pFrame->withPar == true) flags |= COM_BIN_FLAG_WITH_PAR;
+    if (pFrame->tagged == true)  flags |= COM_BIN_FLAG_TAGGED;
+
+    ComBinaryWriter writer(pOut);
+    writer.begin();
+    writer.put(COM_BIN_TYPE_ANSWER);
+    writer.put((uint8_t)pFrame->module);
+    writer.put(pFrame->index);
+    writer.put(flags);
+    writer.putUint16(COM_BIN_HEADER_LENGTH + cmdLength + strLength + textLength + resLength + dataField);
+    writer.put(cmdLength);
+    writer.putUint16(strLength);
+    writer.putUint16(textLength + resLength);
+    writer.putUint32(pFrame->cfg.par0.uint32);
+    writer.putUint32(pFrame->cfg.par1.uint32);
+    writer.putUint32(pFrame->cfg.par2.uint32);
+    writer.putUint32(pFrame->cfg.par3.uint32);
+    writer.putUint16(pFrame->tag);
+    writer.put((const uint8_t *)pFrame->command.c_str(), cmdLength);
+    writer.put((const uint8_t *)pFrame->cfg.str.c_str(), strLength);
+    writer.put((const uint8_t *)pText, textLength);
+    writer.put((const uint8_t *)pRes, resLength);
+    if (dataLength > 0) {
+        writer.putUint16(dataLength);
+        writer.put(pFrame->data, dataLength);
+    }
+    writer.end();
+}
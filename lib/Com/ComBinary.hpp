@@ -0,0 +1,117 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 MonkeyCodeMen@GitHub
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * provided to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#pragma once
+#include <Arduino.h>
+#include <ComFrame.hpp>
+
+/*
+    binary frame mode (runs in parallel to the ASCII "S:" frames on the same line)
+
+    wire:       COM_BIN_FRAME_START | COBS( payload | crc16 ) | 0x00
+
+    payload:    offset  size    content
+                0       1       type        COM_BIN_TYPE_REQUEST / COM_BIN_TYPE_ANSWER
+                1       1       module
+                2       1       index       (binary 0..9, not ASCII)
+                3       1       flags       COM_BIN_FLAG_xxx
+                4       2       length      payload length without crc (little endian)
+                6       1       command length
+                7       2       str length
+                9       2       res length  (0 for requests)
+                11      16      par0..par3  uint32 little endian
+                27      2       tag         (valid if COM_BIN_FLAG_TAGGED is set)
+                29      ..      command, str, res (no terminating zero)
+                ..      2       data length (only if COM_BIN_FLAG_DATA is set)
+                ..      ..      raw data
+
+    crc16:      CRC-16/CCITT-FALSE over complete payload, little endian
+
+    COBS byte stuffing guarantees that 0x00 only shows up as frame delimiter,
+    so the receiver can resync on every 0x00 after a broken frame.
+*/
+
+#define COM_BIN_FRAME_START         0xA5
+#define COM_BIN_FRAME_DELIMITER     0x00
+#define COM_BIN_TYPE_REQUEST        0x01
+#define COM_BIN_TYPE_ANSWER         0x81
+
+#define COM_BIN_FLAG_WITH_PAR       0x01
+#define COM_BIN_FLAG_RESULT_OK      0x02
+#define COM_BIN_FLAG_TAGGED         0x04
+#define COM_BIN_FLAG_CONTINUED      0x08        // answer: intermediate part of a streamed answer, more will follow
+#define COM_BIN_FLAG_DATA           0x10        // raw data with length prefix after command, str, res
+
+#define COM_BIN_HEADER_LENGTH       29
+#define COM_BIN_CRC_LENGTH          2
+#define COM_BIN_DATA_LENGTH_SIZE    2
+#define COM_BIN_PAYLOAD_LENGTH(dataLength)  (COM_BIN_HEADER_LENGTH + COM_FRAME_MAX_COMMAND_LENGTH + COM_FRAME_MAX_STR_LENGTH + COM_BIN_DATA_LENGTH_SIZE + (dataLength) + COM_BIN_CRC_LENGTH)
+#define COM_BIN_ENCODED_LENGTH(dataLength)  (COM_BIN_PAYLOAD_LENGTH(dataLength) + COM_BIN_PAYLOAD_LENGTH(dataLength)/254 + 1)
+#define COM_BIN_MAX_PAYLOAD_LENGTH  COM_BIN_PAYLOAD_LENGTH(COM_FRAME_MAX_DATA_LENGTH)
+#define COM_BIN_MAX_ENCODED_LENGTH  COM_BIN_ENCODED_LENGTH(COM_FRAME_MAX_DATA_LENGTH)
+
+// decode a COBS block (without delimiter) .. in place decoding (pOut == pIn) is allowed
+// returns decoded length or 0 on error
+size_t cobsDecode(const uint8_t * pIn, size_t length, uint8_t * pOut);
+
+// check crc / length fields of a decoded payload and copy the content to the frame
+bool comBinaryToFrame(const uint8_t * pPayload, size_t length, ComFrame * pFrame);
+
+
+/**
+ * @class ComBinaryWriter
+ * @brief streams one binary frame (COBS + crc16) to a Print object without building it in RAM first
+ *
+ * usage:   begin(), put() all payload bytes, end()
+ */
+class ComBinaryWriter {
+public:
+    ComBinaryWriter(Print * pOut) : _pOut(pOut), _count(0), _crc(0xFFFF) {}
+
+    void begin();
+    void put(uint8_t value);
+    void put(const uint8_t * p, size_t length);
+    void putUint16(uint16_t value);
+    void putUint32(uint32_t value);
+    void end();
+
+private:
+    void _stuff(uint8_t value);
+    void _flushBlock();
+
+    Print *  _pOut;
+    uint8_t  _block[254];
+    uint8_t  _count;
+    uint16_t _crc;
+};
+
+// write a complete binary answer frame for pFrame
+void comBinaryWriteAnswer(Print * pOut, bool res, ComFrame * pFrame);
+
+// write one binary answer frame with result text pText + pRes (i.e. streamed text and pFrame->res)
+// resultFlags: COM_BIN_FLAG_RESULT_OK or COM_BIN_FLAG_CONTINUED
+void comBinaryWriteAnswer(Print * pOut, uint8_t resultFlags, ComFrame * pFrame,
+                          const char * pText, size_t textLength, const char * pRes, size_t resLength);
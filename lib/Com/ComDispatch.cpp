@@ -27,27 +27,63 @@
 #include <Debug.hpp>
 #include <helper.h>
 
-ComDispatch::ComDispatch() : _moduleCount(0) {}
+ComDispatch comDispatch;
 
-void ComDispatch::registerModule(ComModule* module) {
-    if (_moduleCount < COM_MAX_MODULES) {
-        _modules[_moduleCount].moduleId = module->getModuleId();
-        _modules[_moduleCount].module = module;
-        _moduleCount++;
+ComDispatch::ComDispatch() : _pOwner(nullptr) {
+    for (uint8_t i = 0; i < COM_DISPATCH_MAX_MODULE_ID; i++) {
+        _table[i] = nullptr;
     }
 }
 
-bool ComDispatch::dispatchFrame(ComFrame *pFrame) {
-    char moduleId = pFrame->module;
+ComDispatch::~ComDispatch() {
+    for (uint8_t i = 0; i < COM_DISPATCH_MAX_MODULE_ID; i++) {
+        delete[] _table[i];
+    }
+}
+
+bool ComDispatch::registerModule(ComModule* module) {
+    uint8_t moduleId = (uint8_t)module->getModuleId();
+    uint8_t index    = module->getModuleIndex();
+
+    if ((moduleId >= COM_DISPATCH_MAX_MODULE_ID) || (index >= COM_DISPATCH_MAX_INDEX)) {
+        LOG(F("COM module id or index out of range"));
+        return false;
+    }
+
+    if (_table[moduleId] == nullptr) {
+        _table[moduleId] = new ComModule*[COM_DISPATCH_MAX_INDEX]();
+    }
+    if (_table[moduleId][index] != nullptr) {
+        LOG("COM module replaced: " + String((char)moduleId) + String(index));
+    }
+    _table[moduleId][index] = module;
+    return true;
+}
 
-    // Suche nach dem Modul mit der passenden Kennung
-    for (uint8_t i = 0; i < _moduleCount; i++) {
-        if (_modules[i].moduleId == moduleId) {
-            return _modules[i].module->dispatchFrame(pFrame);
+void ComDispatch::loop(uint32_t now) {
+    for (uint8_t moduleId = 0; moduleId < COM_DISPATCH_MAX_MODULE_ID; moduleId++) {
+        if (_table[moduleId] == nullptr) continue;
+        for (uint8_t index = 0; index < COM_DISPATCH_MAX_INDEX; index++) {
+            if (_table[moduleId][index] != nullptr) {
+                _table[moduleId][index]->loop(now);
+            }
         }
     }
+}
 
-    // Kein passendes Modul gefunden
-    pFrame->res = "Error: Unknown module ID.";
-    return false;
-}
\ No newline at end of file
+bool ComDispatch::dispatchFrame(ComFrame *pFrame) {
+    uint8_t moduleId = (uint8_t)pFrame->module;
+    uint8_t index    = pFrame->index;
+
+    if ((moduleId >= COM_DISPATCH_MAX_MODULE_ID) || (_table[moduleId] == nullptr)) {
+        pFrame->res = "Error: Unknown module ID.";
+        return false;
+    }
+
+    if ((index >= COM_DISPATCH_MAX_INDEX) || (_table[moduleId][index] == nullptr)) {
+        pFrame->res = "Error: Unknown module index.";
+        return false;
+    }
+
+    return _table[moduleId][index]->dispatchFrame(pFrame);
+}
@@ -29,22 +29,36 @@
 #include <ComFrame.hpp>
 #include <ComModule.hpp>
 
-#define COM_MAX_MODULES 10 // Maximum number of modules
+#define COM_DISPATCH_MAX_MODULE_ID  128     // module id is an ASCII char
+#define COM_DISPATCH_MAX_INDEX      10      // index 0..9 of a module
 
+class Com;
+
+/*
+    direct indexed module table: _table[module char][index]
+    the row for a module char is allocated on first registration, so there is no fixed
+    limit of modules and the dispatch cost is always two array accesses
+*/
 class ComDispatch {
 public:
     ComDispatch();
+    ~ComDispatch();
+    ComDispatch(const ComDispatch&) = delete;               // owns the rows of _table
+    ComDispatch& operator=(const ComDispatch&) = delete;
     bool dispatchFrame(ComFrame *pFrame);
+    void loop(uint32_t now);        // calls loop() of all registered modules
 
-    // Registriert ein Modul mit seiner Kennung
-    void registerModule(ComModule* module);
+    // links using this table .. only the first one (owner) calls loop(), so modules run their loop once per cycle
+    void attach(Com * pLink)                { if (_pOwner == nullptr) _pOwner = pLink; }
+    bool isOwner(const Com * pLink) const   { return _pOwner == pLink; }
 
-private:
-    struct ModuleEntry {
-        char moduleId;
-        ComModule* module;
-    };
+    // register a module for its id and index .. an already registered module with same id and index will be replaced
+    bool registerModule(ComModule* module);
 
-    ModuleEntry _modules[COM_MAX_MODULES]; // Array für Module
-    uint8_t _moduleCount;              // Anzahl der registrierten Module
+private:
+    ComModule** _table[COM_DISPATCH_MAX_MODULE_ID];     // rows of COM_DISPATCH_MAX_INDEX entries
+    Com *       _pOwner;
 };
+
+// module table shared by all COM links (see Com)
+extern ComDispatch comDispatch;
\ No newline at end of file
@@ -26,15 +26,27 @@
 
 #pragma once
 #include <Arduino.h>
+
+#define COM_FRAME_MAX_COMMAND_LENGTH    50
+#define COM_FRAME_MAX_PARAMETER_LENGTH  30
+#define COM_FRAME_MAX_STR_LENGTH        250
+
+// raw data of binary frames (i.e. file chunks) .. max size, each link can use smaller buffers (see Com constructor)
+#ifndef COM_FRAME_MAX_DATA_LENGTH
+#define COM_FRAME_MAX_DATA_LENGTH       2048
+#endif
+
 #include <cfgPar.hpp>
+#include <FixedString.hpp>
 
 /*
     for details see: README
 
-    Start,ModuleIndex,Command,Par1,Par2,Par3,Par4,str,length,data#
+    Start,ModuleIndex[@Tag],Command,Par1,Par2,Par3,Par4,str,length,data#
 
     simple example
     S:L0,On#   {start:"S:""  Module:"S" Index:"0" ; Command:"on" end:"#""}
+    S:L0@7,On# same with request tag 7 .. will be echoed in the answer: A:L0@7,On#OK-#
 
     must have: start module command
     other paramtres are optional
@@ -48,6 +60,10 @@
                 CX:  common
                 ... to be continued
                 X:   0..9 index for module
+
+    Tag:        [@ & uint16_t as string] optional
+                request tag, echoed in the answer, so a host can keep several requests in flight
+                and match answers that come back in a different order (deferred answers)
     
     Command:    [String] max length: COM_FRAME_MAX_COMMAND_LENGTH 
                 max length COM_FRAME_MAX_PAR_LENGTH
@@ -64,42 +80,74 @@
 
 */
 
-#define COM_FRAME_MAX_COMMAND_LENGTH    50
-#define COM_FRAME_MAX_PARAMETER_LENGTH  30
-#define COM_FRAME_MAX_STR_LENGTH        250
 #define COM_FRAME_START1            'S'
 #define COM_FRAME_START2            ':'
 #define COM_FRAME_END               '#'
 #define COM_FRAME_SEP               ','
 #define COM_FRAME_PARAMETER_SEP     ';'
 #define COM_FRAME_TEXT_QUOTES       '"'
+#define COM_FRAME_TAG_START         '@'
 #define COM_FRAME_ANSWER_START      "A:"
+#define COM_FRAME_RESULT_OK         "OK-"
+#define COM_FRAME_RESULT_NOK        "NOK-"
+#define COM_FRAME_RESULT_CONTINUE   "CNT-"       // intermediate part of a streamed answer .. more parts will follow
+
 
 
 
 
+class Com;
 
 class ComFrame{
     public:
-        ComFrame(): module(0),index(0),command(""),cfg(0,0,0,0,""),res(""),withPar(false)  {}
-        ~ComFrame() {cfg.str = "";   }
+        ComFrame(): module(0),index(0),tagged(false),tag(0),command(""),withPar(false),cfg(0,0,0,0,""),res(""),binary(false),dataLength(0),dataSize(0),data(nullptr),deferred(false),out(nullptr),link(nullptr)  {}
+        ~ComFrame() = default;
+
+        // no heap allocation: command and cfg.str use inline buffers, res keeps its buffer
         void reset(){
             module = ' ';
             index  = 0;
-            command == "";
-            cfg = cfgPar(0,0,0,0,"");
+            tagged = false;
+            tag    = 0;
+            command.clear();
+            cfg.clear();
             withPar = false;
             res ="";
+            binary = false;
+            dataLength = 0;
+            deferred = false;
+            out = nullptr;
         }
 
         char    module;
         uint8_t index;
-        String  command;
+        bool    tagged;
+        uint16_t tag;
+        FixedString<COM_FRAME_MAX_COMMAND_LENGTH> command;
 
         // parameter       
         bool        withPar;                
         cfgPar      cfg;
 
-        // result
+        // result (String, because some answers (dump, list) are much longer than a frame)
         String res;
+
+        // frame received in binary mode (see ComBinary.hpp) .. answer will be sent binary too
+        bool   binary;
+
+        // raw data (binary frames only) .. set dataLength to 0 if the answer shall not contain data
+        uint16_t dataLength;
+        uint16_t dataSize;              // size of the data buffer (set by the link, not changed by reset)
+        uint8_t * data;                 // buffer of the link
+
+        // set by a command handler, if the answer will be sent later with pFrame->link->answerDeferred()
+        // the frame stays in the receive queue until then
+        bool   deferred;
+
+        // answer stream .. only valid during dispatch (nullptr otherwise)
+        // long answers are printed here and sent in parts (see ComAnswerStream.hpp)
+        Print * out;
+
+        // COM link the frame was received on (not changed by reset) .. a deferred answer is sent with pFrame->link->answerDeferred()
+        Com *   link;
 };
\ No newline at end of file
@@ -0,0 +1,74 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 MonkeyCodeMen@GitHub
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * provided to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include "ComModule.hpp"
+#include <Debug.hpp>
+#include <helper.h>
+#include <ComWorker.hpp>
+
+
+void ComModule::registerCommand(const char * name, ComCommandHandler_t handler, bool background) {
+    ASSERT(name != nullptr, F("invalid command name"));
+    uint32_t hash = stringHash(name);
+
+    auto it = _commands.find(hash);
+    if (it != _commands.end()) {
+        ASSERT(strcmp(it->second.name, name) == 0, "hash collision of COM commands: " + String(name) + " / " + String(it->second.name));
+        LOG("COM command registered twice (last one wins): " + String(name));
+    }
+    _commands[hash] = CommandEntry{name, handler, background};
+}
+
+bool ComModule::dispatchFrame(ComFrame* pFrame) {
+    const char * command = pFrame->command.c_str();
+
+    auto it = _commands.find(stringHash(command));
+    if ((it != _commands.end()) && (strcmp(it->second.name, command) == 0)) {
+        if ((it->second.background == true) && (comWorker.submit(pFrame, &it->second.handler) == true)) {
+            return true;            // deferred .. answered when the worker is done
+        }
+        return it->second.handler(pFrame);
+    }
+
+    if (pFrame->command == COM_MODULE_LIST_COMMAND) {
+        listCommands(*pFrame->out);
+        return true;
+    }
+
+    pFrame->res = "Error: Unknown command.";
+    return false;
+}
+
+void ComModule::listCommands(Print& out) const {
+    bool first = true;
+    for (const auto& entry : _commands) {
+        if (first == false) {
+            out.print(", ");
+        }
+        out.print(entry.second.name);
+        first = false;
+    }
+}
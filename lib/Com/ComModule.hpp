@@ -1,23 +1,57 @@
 // ComModule.hpp
 #pragma once
 #include <Arduino.h>
+#include <unordered_map>
+#include <functional>
 #include "ComFrame.hpp"
 
+#define COM_MODULE_LIST_COMMAND     "list"      // built in command: list all registered commands of a module
 
+typedef std::function<bool(ComFrame*)> ComCommandHandler_t;
+
+/*
+    base class of all COM modules
+
+    a module registers its commands once (i.e. in the constructor):
+        registerCommand("FILE read", [this](ComFrame* pFrame) { return _readFile(pFrame); });
+
+    the default dispatchFrame() looks up the command by its precomputed hash (stringHash),
+    so the dispatch cost does not depend on the number of commands of a module.
+    the command "list" is handled automatically, as long as the module has not registered its own "list".
+    commands with background = true (slow flash operations) are executed by comWorker on core0 and answered deferred.
+*/
 class ComModule {
 public:
     // no constructor, no copy constructor, no assignment operator
-    ComModule(char id) : _com_module_id(id){}
+    ComModule(char id, uint8_t index = 0) : _com_module_id(id), _com_module_index(index){}
 
     // default destructor
     virtual ~ComModule() = default;
 
-    // virtual method to dispatch a frame to the module (interface)
-    virtual bool dispatchFrame(ComFrame* pFrame) = 0;
+    // dispatch a frame to the registered command handler .. can be overridden for special handling
+    virtual bool dispatchFrame(ComFrame* pFrame);
+
+    // cyclic call from Com::loop (i.e. timeouts) .. once per cycle, by the first link of the dispatcher (see ComDispatch::attach)
+    virtual void loop(uint32_t /*now*/) {}
 
     // virtual method to get the module ID (interface)
     const char getModuleId() const {return _com_module_id;}
+    uint8_t getModuleIndex() const {return _com_module_index;}
+
+protected:
+    // name must be a static string (will not be copied)
+    // background: run in comWorker (core0 loop), the handler must not touch data of core1 without protection
+    void registerCommand(const char * name, ComCommandHandler_t handler, bool background = false);
+    void listCommands(Print& out) const;
+
 private:
-    char _com_module_id;
+    struct CommandEntry {
+        const char *        name;
+        ComCommandHandler_t handler;
+        bool                background;
+    };
 
+    char    _com_module_id;
+    uint8_t _com_module_index;     // 0..9 .. several instances of one module id can be registered with different index
+    std::unordered_map<uint32_t, CommandEntry> _commands;   // key: stringHash(name)
 };
@@ -14,26 +14,25 @@
  */
 class ComModuleDump : public ComModule {
 public:
-    ComModuleDump() : ComModule('I') {}
-
-    /**
-     * @brief Handles incoming commands for the Dumper system.
-     * @param frame The communication frame containing the command and parameters.
-     * @return True if the command was handled successfully, false otherwise.
-     */
-    bool dispatchFrame(ComFrame * pFrame) override {
-        if (pFrame->command == "list") {
-            pFrame->res  = "Dumper list:";
-            pFrame->res += dumper.list();
-            return true;
-        } else if (pFrame->command == "dump") {
-            pFrame->res  = "Dumper dump:";
-            pFrame->res += dumper.callDumpFunction(pFrame->cfg.str,millis());
-            return true;
-        }
-        pFrame->res = "Error: Unknown dumper command.";
-        return false;
+    ComModuleDump() : ComModule('I') {
+        registerCommand("list", [this](ComFrame * pFrame) { return _list(pFrame); });
+        registerCommand("dump", [this](ComFrame * pFrame) { return _dump(pFrame); });
     }
 
 private:
+    // both answers are streamed (see ComAnswerStream) .. a dump can be much longer than a frame
+    bool _list(ComFrame * pFrame) {
+        pFrame->out->print("Dumper list:");
+        dumper.list(*pFrame->out);
+        return true;
+    }
+
+    bool _dump(ComFrame * pFrame) {
+        pFrame->out->print("Dumper dump:");
+        if (dumper.streamDumpFunction(String(pFrame->cfg.str.c_str()),*pFrame->out,millis()) == false) {
+            pFrame->res = "Error: unknown dump name.";
+            return false;
+        }
+        return true;
+    }
 };
\ No newline at end of file
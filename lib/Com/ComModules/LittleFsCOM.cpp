@@ -1,46 +1,99 @@
 #include "LittleFsCOM.hpp"
 #include <Base64.hpp>
+#include <helper.h>
+#include <Debug.hpp>
+#include <ComWorker.hpp>
+#include <Split.hpp>
 
 
 
 
 
-bool LittleFsCOM::dispatchFrame(ComFrame* pFrame) {
-    if (pFrame->command == "FILE read") {
-        return _readFile(pFrame);
-    } else if (pFrame->command == "FILE write") {
-        return _writeFile(pFrame);
-    } else if (pFrame->command == "FILE delete") {
-        return _deleteFile(pFrame);
-    } else if (pFrame->command == "FILE mkdir") {
-        return _createDirectory(pFrame);
-    } else if (pFrame->command == "FILE rmdir") {
-        return _deleteDirectory(pFrame);
-    }  else if (pFrame->command == "FILE list"){
-        pFrame->res = "directory of LittleFS:\n";
-        pFrame->res += _listDirectory(String("/"),String("")); 
-        return true;
-    }    
+LittleFsCOM::LittleFsCOM() : ComModule('F') {
+    LittleFS.begin();
 
-    return false;
-        pFrame->res = "Error: Unknown LittleFS command.";
-    return false;
+    // slow file commands run in comWorker (core0) .. core1 keeps serving COM and LEDs in the meantime
+    registerCommand("FILE read",   [this](ComFrame *pFrame) { FsLock lock; return _readFile(pFrame);        }, true);
+    registerCommand("FILE write",  [this](ComFrame *pFrame) { FsLock lock; return _writeFile(pFrame);       }, true);
+    registerCommand("FILE patch",  [this](ComFrame *pFrame) { FsLock lock; return _patchFile(pFrame);       }, true);
+    registerCommand("FILE delete", [this](ComFrame *pFrame) { FsLock lock; return _deleteFile(pFrame);      }, true);
+    registerCommand("FILE mkdir",  [this](ComFrame *pFrame) { FsLock lock; return _createDirectory(pFrame); }, true);
+    registerCommand("FILE rmdir",  [this](ComFrame *pFrame) { FsLock lock; return _deleteDirectory(pFrame); }, true);
+    registerCommand("FILE copy",   [this](ComFrame *pFrame) { FsLock lock; return _copyFile(pFrame);        }, true);
+    registerCommand("FILE move",   [this](ComFrame *pFrame) { FsLock lock; return _moveFile(pFrame);        }, true);
+
+    // streamed answers .. inline on core1, but not while core0 (worker, config) uses the file system
+    registerCommand("FILE hash",   [this](ComFrame *pFrame) { FsLock lock(false); return _idle(pFrame, lock) && _hashFile(pFrame); });
+    registerCommand("FILE list",   [this](ComFrame *pFrame) { FsLock lock(false); return _idle(pFrame, lock) && _list(pFrame);     });
+    registerCommand("FILE ls",     [this](ComFrame *pFrame) { FsLock lock(false); return _idle(pFrame, lock) && _listPage(pFrame); });
+    registerCommand("FILE tail",   [this](ComFrame *pFrame) { FsLock lock(false); return _idle(pFrame, lock) && _tailFile(pFrame); });
 }
 
-String LittleFsCOM::_listDirectory(String path, String header) {
-    String result = header;
-    Dir dir = LittleFS.openDir(path);
+void LittleFsCOM::loop(uint32_t now) {
+    if (comWorker.isIdle() == false) return;    // transfer state belongs to the worker right now
 
-    while (dir.next()) {
-        if (dir.isDirectory()) {
-            result += path + dir.fileName() + "/\n";
-            result += _listDirectory(path + dir.fileName() + "/", String("")); // Recursive call for subdirectories
-        } else {
-            result += path + dir.fileName() + "*" + String(dir.fileSize()) + "\n";
-        }
+    // signed difference: lastAccess (millis() in the handler) can be newer than now of this loop
+    if ((_fileTransferState.isActive == true) && ((int32_t)(now - _fileTransferState.lastAccess) > COM_FILE_TRANSFER_TIMEOUT_MS)) {
+        FsLock lock(false);         // core1 .. try again in the next loop if core0 uses the file system
+        if (lock.isLocked() == false) return;
+        LOG("COM file transfer timeout: " + _fileTransferState.filename);
+        _fileTransferState.reset();
     }
+}
 
-    return result;
+// LittleFS is not safe for access of both cores at the same time
+bool LittleFsCOM::_idle(ComFrame *pFrame, const FsLock& lock) {
+    if ((lock.isLocked() == false) || (comWorker.isIdle() == false)) {
+        pFrame->res = "Error: busy, file operation running.";
+        return false;
+    }
+    return true;
+}
+
+bool LittleFsCOM::_list(ComFrame *pFrame) {
+    // streamed .. the directory can be much longer than a frame
+    pFrame->out->print("directory of LittleFS:\n");
+    fsStatCache.forEach(0, SIZE_MAX, [pFrame](const FsStatEntry& entry) { _printEntry(pFrame->out, entry); });
+    return true;
+}
+
+// paginated listing: P2 cursor (0: first entry), P3 max entries (0: COM_FILE_LIST_PAGE_SIZE), P1 generation of the first page
+// answer: P1 generation, P2 next cursor (0: end of listing), P3 entries of this page, P4 total entries
+bool LittleFsCOM::_listPage(ComFrame *pFrame) {
+    uint32_t cursor     = pFrame->cfg.COM_FILE_P2.uint32;
+    uint32_t maxEntries = pFrame->cfg.COM_FILE_P3.uint32;
+    uint32_t generation = fsStatCache.generation();
+    uint32_t total      = fsStatCache.count();
+
+    if ((cursor != 0) && (pFrame->cfg.COM_FILE_P1.uint32 != generation)) {
+        pFrame->res = "Error: directory changed, restart listing.";
+        pFrame->cfg.COM_FILE_P1.uint32 = generation;
+        return false;
+    }
+    if (cursor > total) {
+        pFrame->res = "Error: Invalid cursor.";
+        return false;
+    }
+    if (maxEntries == 0) {
+        maxEntries = COM_FILE_LIST_PAGE_SIZE;
+    }
+    maxEntries = min(maxEntries, (uint32_t)COM_FILE_LIST_MAX_PAGE_SIZE);
+
+    size_t count = fsStatCache.forEach(cursor, maxEntries, [pFrame](const FsStatEntry& entry) { _printEntry(pFrame->out, entry); });
+    pFrame->cfg.COM_FILE_P1.uint32 = generation;
+    pFrame->cfg.COM_FILE_P2.uint32 = (cursor + count < total) ? cursor + count : 0;
+    pFrame->cfg.COM_FILE_P3.uint32 = count;
+    pFrame->cfg.COM_FILE_P4.uint32 = total;
+    return true;
+}
+
+// same format as before the cache: "<path>/" for directories, "<path>*<size>" for files
+void LittleFsCOM::_printEntry(Print * pOut, const FsStatEntry& entry) {
+    if (entry.isDirectory) {
+        pOut->print(entry.path + "\n");
+    } else {
+        pOut->print(entry.path + "*" + String(entry.size) + "\n");
+    }
 }
 
 bool LittleFsCOM::_readFile(ComFrame *pFrame) {
@@ -49,32 +102,44 @@ bool LittleFsCOM::_readFile(ComFrame *pFrame) {
     if (sequenz == COM_FILE_INIT) {
         _fileTransferState.reset();
 
-        _fileTransferState.filename = pFrame->cfg.str;
-        File file = LittleFS.open(_fileTransferState.filename, "r");
-        if (!file) {
+        _fileTransferState.filename = pFrame->cfg.str.c_str();
+        _fileTransferState.file = LittleFS.open(_fileTransferState.filename, "r");
+        if (!_fileTransferState.file) {
             pFrame->res = "Error: File not found: " + _fileTransferState.filename;
+            _fileTransferState.reset();
             return false;
         }
 
-        _fileTransferState.fileSize = file.size();
-        _fileTransferState.totalChunks = (_fileTransferState.fileSize + MAX_FILE_CHUNK_SIZE - 1) / MAX_FILE_CHUNK_SIZE;
+        if (_initWindow(pFrame) == false) {
+            _fileTransferState.reset();
+            return false;
+        }
+        if (_fileTransferState.bundle == true) {
+            pFrame->res = "Error: bundle flag only for FILE write.";
+            _fileTransferState.reset();
+            return false;
+        }
+        _fileTransferState.lastAccess = millis();
+        _fileTransferState.fileSize = _fileTransferState.file.size();
+        _fileTransferState.totalChunks = (_fileTransferState.fileSize + _fileTransferState.chunkSize - 1) / _fileTransferState.chunkSize;
         _fileTransferState.currentChunk = 1;
         _fileTransferState.isActive = true;
 
         pFrame->cfg.COM_FILE_P1.uint32 = COM_FILE_INIT;
-        pFrame->cfg.COM_FILE_P2.uint32 = 0;
         pFrame->cfg.COM_FILE_P3.uint32 = _fileTransferState.totalChunks;
         pFrame->cfg.COM_FILE_P4.uint32 = _fileTransferState.fileSize;
         pFrame->cfg.str = _fileTransferState.filename;
 
         pFrame->res = "";
-        file.close();
         return true;
     } else if (sequenz == COM_FILE_DATA) {
         if (!_fileTransferState.isActive) {
             pFrame->res = "Error: No active file read sequence.";
             return false;
         }
+        if (_fileTransferState.useOffsets == true) {
+            return _readChunkWindowed(pFrame);
+        }
 
         uint32_t chunk = pFrame->cfg.COM_FILE_P2.uint32;
         if ((chunk != _fileTransferState.currentChunk) || (chunk < 1)) {
@@ -82,17 +147,15 @@ bool LittleFsCOM::_readFile(ComFrame *pFrame) {
             return false;
         }
 
-        File file = LittleFS.open(_fileTransferState.filename, "r");
-        if (!file) {
-            pFrame->res = "Error: File not found: " + _fileTransferState.filename;
+        uint32_t offset = (_fileTransferState.currentChunk - 1) * _fileTransferState.chunkSize;
+        uint8_t buffer[MAX_FILE_CHUNK_SIZE];
+        uint32_t bytesToRead = min((uint32_t)_fileTransferState.chunkSize, _fileTransferState.fileSize - offset);
+        if (_fileTransferState.readAt(offset, buffer, bytesToRead) != bytesToRead) {
+            pFrame->res = "Error: Failed to read file: " + _fileTransferState.filename;
+            _fileTransferState.reset();
             return false;
         }
-        uint32_t offset = (_fileTransferState.currentChunk - 1) * MAX_FILE_CHUNK_SIZE;
-        file.seek(offset);
-        uint8_t buffer[MAX_FILE_CHUNK_SIZE];
-        uint32_t bytesToRead = min((uint32_t)MAX_FILE_CHUNK_SIZE, _fileTransferState.fileSize - offset);
-        file.read(buffer, bytesToRead);
-        file.close();
+        _fileTransferState.lastAccess = millis();
 
         char bufferBase64[COM_FRAME_MAX_STR_LENGTH];
         encode_base64(buffer, bytesToRead, (uint8_t *)bufferBase64);
@@ -100,7 +163,7 @@ bool LittleFsCOM::_readFile(ComFrame *pFrame) {
         pFrame->cfg.COM_FILE_P2.uint32 = _fileTransferState.currentChunk;
         pFrame->cfg.COM_FILE_P3.uint32 = _fileTransferState.totalChunks;
         pFrame->cfg.COM_FILE_P4.uint32 = _fileTransferState.fileSize;
-        pFrame->cfg.str = String(bufferBase64);
+        pFrame->cfg.str = bufferBase64;
         pFrame->res = "";
 
         _fileTransferState.currentChunk++;
@@ -108,6 +171,23 @@ bool LittleFsCOM::_readFile(ComFrame *pFrame) {
             _fileTransferState.reset();
         }
 
+        return true;
+    } else if (sequenz == COM_FILE_FINISH) {
+        if (!_fileTransferState.isActive) {
+            pFrame->res = "Error: No active file read sequence.";
+            return false;
+        }
+        // P3 file size, P4 crc32 of the complete file
+        uint32_t crc;
+        if (_crcOfFile(_fileTransferState.fileSize, crc) == false) {
+            pFrame->res = "Error: Failed to read file: " + _fileTransferState.filename;
+            _fileTransferState.reset();
+            return false;
+        }
+        pFrame->cfg.COM_FILE_P3.uint32 = _fileTransferState.fileSize;
+        pFrame->cfg.COM_FILE_P4.uint32 = crc;
+        pFrame->res = "";
+        _fileTransferState.reset();
         return true;
     }
 
@@ -121,43 +201,85 @@ bool LittleFsCOM::_writeFile(ComFrame *pFrame) {
 
     if (sequenz == COM_FILE_INIT) {
         _fileTransferState.reset();
-        _fileTransferState.filename = pFrame->cfg.str;
+        _fileTransferState.filename = pFrame->cfg.str.c_str();
         _fileTransferState.currentChunk = pFrame->cfg.COM_FILE_P2.uint32;
         _fileTransferState.totalChunks = pFrame->cfg.COM_FILE_P3.uint32;
         _fileTransferState.fileSize = pFrame->cfg.COM_FILE_P4.uint32;
         _fileTransferState.isActive = true;
         pFrame->res = "";
 
-        if (LittleFS.exists(_fileTransferState.filename)) {
-            if (!LittleFS.remove(_fileTransferState.filename)) {
-                pFrame->res = "Error: Failed to delete existing file with same filename.";
-                return false;
-            }
-            pFrame->res = "Existing file deleted.";
+        if (_initWindow(pFrame) == false) {
+            _fileTransferState.reset();
+            return false;
+        }
+        if (_fileTransferState.useOffsets == true) {
+            // windowed / raw: chunk count follows from negotiated chunk size
+            _fileTransferState.totalChunks = (_fileTransferState.fileSize + _fileTransferState.chunkSize - 1) / _fileTransferState.chunkSize;
         }
 
-        File file = LittleFS.open(_fileTransferState.filename, "w");
-        if (!file) {
-            pFrame->res += "Error: Failed to create new file: " + _fileTransferState.filename;
+        // data goes to <file>.part .. the existing file is replaced only after a complete transfer
+        String partName = _fileTransferState.partName();
+        uint32_t resumeOffset = 0;
+        if ((_fileTransferState.resume == true) && LittleFS.exists(partName)) {
+            _fileTransferState.file = LittleFS.open(partName, "r+");
+            if (_fileTransferState.file) {
+                // trust all complete chunks on flash, the host checks them with the crc
+                resumeOffset = min((uint32_t)_fileTransferState.file.size(), _fileTransferState.fileSize);
+                resumeOffset = (resumeOffset / _fileTransferState.chunkSize) * _fileTransferState.chunkSize;
+                // drop a partial chunk at the end, the next chunk is written at resumeOffset
+                if (_fileTransferState.file.truncate(resumeOffset) == false) {
+                    _fileTransferState.file.close();        // start again with an empty <file>.part
+                    resumeOffset = 0;
+                }
+            }
+        }
+        if (!_fileTransferState.file) {
+            _fileTransferState.file = LittleFS.open(partName, "w");
+        }
+        fsStatCache.invalidate();
+        if (!_fileTransferState.file) {
+            pFrame->res = "Error: Failed to create new file: " + partName;
             _fileTransferState.reset();
             return false;
         }
+        _fileTransferState.isWrite = true;
+        _fileTransferState.lastAccess = millis();
+        _fileTransferState.currentChunk = resumeOffset / _fileTransferState.chunkSize + 1;
 
-        file.close();
         pFrame->cfg.COM_FILE_P1.uint32 = COM_FILE_INIT;
-        pFrame->cfg.COM_FILE_P2.uint32 = 0;
-        pFrame->cfg.COM_FILE_P3.uint32 = _fileTransferState.totalChunks;
-        pFrame->cfg.COM_FILE_P4.uint32 = _fileTransferState.fileSize;
+        if (_fileTransferState.resume == true) {
+            // resume: P3 bytes already on flash (full chunks), P4 crc32 of these bytes
+            uint32_t crc;
+            if (_crcOfFile(resumeOffset, crc) == false) {
+                pFrame->res = "Error: Failed to read file: " + partName;
+                _fileTransferState.reset();
+                return false;
+            }
+            pFrame->cfg.COM_FILE_P3.uint32 = resumeOffset;
+            pFrame->cfg.COM_FILE_P4.uint32 = crc;
+        } else {
+            pFrame->cfg.COM_FILE_P3.uint32 = _fileTransferState.totalChunks;
+            pFrame->cfg.COM_FILE_P4.uint32 = _fileTransferState.fileSize;
+        }
         pFrame->cfg.str = _fileTransferState.filename;
 
-        _fileTransferState.currentChunk = 1;
-
+        if (_fileTransferState.totalChunks == 0) {
+            // empty file: no chunks will follow .. replace the file right away
+            return _finishWrite(pFrame, false);
+        }
         return true;
-    } else if (sequenz == COM_FILE_DATA) {
+    } else if ((sequenz == COM_FILE_DATA) || (sequenz == COM_FILE_DATA_LZF)) {
         if (!_fileTransferState.isActive) {
             pFrame->res = "Error: No active file write sequence.";
             return false;
         }
+        if ((sequenz == COM_FILE_DATA_LZF) && (_fileTransferState.compress == false)) {
+            pFrame->res = "Error: compressed chunk without compress flag.";
+            return false;
+        }
+        if (_fileTransferState.useOffsets == true) {
+            return _writeChunkWindowed(pFrame);
+        }
 
         uint32_t chunk = pFrame->cfg.COM_FILE_P2.uint32;
         if (chunk != _fileTransferState.currentChunk) {
@@ -165,30 +287,35 @@ bool LittleFsCOM::_writeFile(ComFrame *pFrame) {
             return false;
         }
 
-        String base64Data = pFrame->cfg.str;
         uint8_t buffer[MAX_FILE_CHUNK_SIZE];
-        size_t decodedLength = decode_base64((const uint8_t *)base64Data.c_str(), base64Data.length(), buffer);
+        size_t decodedLength = _decodeChunk(pFrame, buffer);
         if (decodedLength == 0) {
-            pFrame->res = "Error: Base64 decode failed.";
             return false;
         }
 
-        File file = LittleFS.open(_fileTransferState.filename, "a");
-        if (!file) {
+        if (_fileTransferState.file.write(buffer, decodedLength) != decodedLength) {
             pFrame->res = "Error: Failed to write to file: " + _fileTransferState.filename;
             _fileTransferState.reset();
             return false;
         }
-        file.write(buffer, decodedLength);
-        file.close();
+        _fileTransferState.lastAccess = millis();
 
         if (_fileTransferState.currentChunk == _fileTransferState.totalChunks) {
-            _fileTransferState.reset();
-            pFrame->res = "File write completed.";
-        } else {
-            _fileTransferState.currentChunk++;
+            // stop and wait: no digest .. replace the file right away
+            return _finishWrite(pFrame, false);
         }
+        _fileTransferState.currentChunk++;
         return true;
+    } else if (sequenz == COM_FILE_FINISH) {
+        if (!_fileTransferState.isActive) {
+            pFrame->res = "Error: No active file write sequence.";
+            return false;
+        }
+        if (_fileTransferState.currentChunk <= _fileTransferState.totalChunks) {
+            pFrame->res = "Error: Missing chunks, first missing: " + String(_fileTransferState.currentChunk);
+            return false;
+        }
+        return _finishWrite(pFrame, true);
     }
 
     pFrame->res = "Error: Invalid sequence id P1:" + String(sequenz, HEX);
@@ -196,8 +323,813 @@ bool LittleFsCOM::_writeFile(ComFrame *pFrame) {
     return false;
 }
 
+// INIT P2: window size, flags and chunk size .. answered with the accepted values (0 stays 0 for stop and wait hosts)
+bool LittleFsCOM::_initWindow(ComFrame *pFrame) {
+    uint32_t options   = pFrame->cfg.COM_FILE_P2.uint32;
+    uint32_t window    = options & COM_FILE_WINDOW_MASK;
+    uint32_t flags     = options & COM_FILE_FLAGS_MASK;
+    uint32_t chunkSize = options >> COM_FILE_CHUNK_SIZE_SHIFT;
+    bool     raw       = (flags & COM_FILE_FLAG_RAW) ? true : false;
+    bool     resume    = (flags & COM_FILE_FLAG_RESUME) ? true : false;
+    bool     compress  = (flags & COM_FILE_FLAG_COMPRESS) ? true : false;
+    bool     bundle    = (flags & COM_FILE_FLAG_BUNDLE) ? true : false;
+    uint32_t maxChunk  = (raw == true) ? min((uint32_t)COM_FILE_MAX_RAW_CHUNK_SIZE, (uint32_t)pFrame->dataSize) : MAX_FILE_CHUNK_SIZE;
+
+    if (flags & ~(COM_FILE_FLAG_RAW | COM_FILE_FLAG_RESUME | COM_FILE_FLAG_COMPRESS | COM_FILE_FLAG_BUNDLE)) {
+        pFrame->res = "Error: unsupported transfer flags.";
+        return false;
+    }
+    if ((raw == true) && (pFrame->binary == false)) {
+        pFrame->res = "Error: raw transfer needs binary frames.";
+        return false;
+    }
+    if (chunkSize == 0) {
+        chunkSize = maxChunk;
+    }
+    if (chunkSize > maxChunk) {
+        pFrame->res = "Error: chunk size too big (max " + String(maxChunk) + ").";
+        return false;
+    }
+    window = clampUint32(1, window, COM_FILE_MAX_WINDOW);
+
+    _fileTransferState.raw        = raw;
+    _fileTransferState.resume     = resume;
+    _fileTransferState.compress   = compress;
+    _fileTransferState.bundle     = bundle;
+    _fileTransferState.useOffsets = (window > 1) || (raw == true) || (resume == true) || (compress == true);
+    _fileTransferState.windowSize = window;
+    _fileTransferState.chunkSize  = chunkSize;
+    pFrame->cfg.COM_FILE_P2.uint32 = (options == 0) ? 0 : (window | flags | (chunkSize << COM_FILE_CHUNK_SIZE_SHIFT));
+    return true;
+}
+
+// windowed write: P2 chunk [1..max], P3 offset .. chunks may arrive in any order inside of the window
+// answer: P2 cumulative ack (all chunks up to P2 written), P3 selective ack (bit i: chunk P2+1+i written)
+bool LittleFsCOM::_writeChunkWindowed(ComFrame *pFrame) {
+    FileTransferState & state = _fileTransferState;
+    uint32_t chunk  = pFrame->cfg.COM_FILE_P2.uint32;
+    uint32_t offset = pFrame->cfg.COM_FILE_P3.uint32;
+    bool     lzf    = (pFrame->cfg.COM_FILE_P1.uint32 == COM_FILE_DATA_LZF);
+    uint16_t dataLength = pFrame->dataLength;
+    pFrame->dataLength = 0;             // answer without data (the buffer stays valid)
+
+    if ((chunk < 1) || (chunk > state.totalChunks) || (offset != (chunk - 1) * state.chunkSize)) {
+        pFrame->res = "Error: Invalid chunk number/offset.";
+        return false;
+    }
+    if (chunk >= state.currentChunk + state.windowSize) {
+        pFrame->res = "Error: Chunk outside of window.";
+        return false;
+    }
+
+    // chunks below the window are written already (ack got lost) .. only send the ack again
+    uint32_t bit = (chunk >= state.currentChunk) ? (1UL << (chunk - state.currentChunk)) : 0;
+    if ((bit != 0) && ((state.windowBitmap & bit) == 0)) {
+        uint8_t buffer[MAX_FILE_CHUNK_SIZE];
+        const uint8_t * pData = buffer;
+        size_t expectedLength = min((uint32_t)state.chunkSize, state.fileSize - offset);
+        size_t decodedLength;
+        if (state.raw == true) {
+            pData = pFrame->data;
+            decodedLength = dataLength;
+        } else {
+            decodedLength = _decodeChunk(pFrame, buffer);
+            if (decodedLength == 0) {
+                return false;
+            }
+        }
+        if (lzf == true) {
+            decodedLength = lzfDecompress(pData, decodedLength, _lzfBuffer, expectedLength);
+            pData = _lzfBuffer;
+        }
+        if (decodedLength != expectedLength) {
+            pFrame->res = "Error: Invalid chunk length.";
+            return false;
+        }
+        if (crc32(pData, decodedLength) != pFrame->cfg.COM_FILE_P4.uint32) {
+            pFrame->res = "Error: Chunk crc mismatch.";
+            return false;
+        }
+
+        if (state.writeAt(offset, pData, decodedLength) != decodedLength) {
+            pFrame->res = "Error: Failed to write to file: " + state.filename;
+            state.reset();
+            return false;
+        }
+
+        // slide window over all chunks without gap
+        state.windowBitmap |= bit;
+        while (state.windowBitmap & 0x01) {
+            state.windowBitmap >>= 1;
+            state.currentChunk++;
+        }
+    }
+
+    state.lastAccess = millis();
+    pFrame->cfg.COM_FILE_P1.uint32 = COM_FILE_DATA;
+    pFrame->cfg.COM_FILE_P2.uint32 = state.currentChunk - 1;
+    pFrame->cfg.COM_FILE_P3.uint32 = state.windowBitmap;
+    pFrame->cfg.COM_FILE_P4.uint32 = state.fileSize;
+    pFrame->cfg.str.clear();            // no echo of the data
+    pFrame->res = "";
+
+    if (state.currentChunk > state.totalChunks) {
+        pFrame->res = "All chunks received.";       // waiting for FINISH with the file crc
+    }
+    return true;
+}
+
+// windowed read: any chunk can be requested (P2 chunk, P3 offset), so the host can keep a window of
+// requests in flight (request tags) and request only the missing chunks again
+bool LittleFsCOM::_readChunkWindowed(ComFrame *pFrame) {
+    FileTransferState & state = _fileTransferState;
+    uint32_t chunk  = pFrame->cfg.COM_FILE_P2.uint32;
+    uint32_t offset = pFrame->cfg.COM_FILE_P3.uint32;
+
+    if ((chunk < 1) || (chunk > state.totalChunks) || (offset != (chunk - 1) * state.chunkSize)) {
+        pFrame->res = "Error: Invalid chunk number/offset.";
+        return false;
+    }
+
+    if ((state.raw == true) && (state.chunkSize > pFrame->dataSize)) {
+        pFrame->res = "Error: chunk size too big for this link.";
+        return false;
+    }
+
+    // raw: read directly into the data buffer of the frame / compress: read into the LZF buffer
+    uint8_t buffer[MAX_FILE_CHUNK_SIZE];
+    uint8_t * pData = (state.raw == true) ? pFrame->data : buffer;
+    uint8_t * pChunk = (state.compress == true) ? _lzfBuffer : pData;
+    uint32_t bytesToRead = min((uint32_t)state.chunkSize, state.fileSize - offset);
+    if (state.readAt(offset, pChunk, bytesToRead) != bytesToRead) {
+        pFrame->res = "Error: Failed to read file: " + state.filename;
+        state.reset();
+        return false;
+    }
+    state.lastAccess = millis();
+
+    pFrame->cfg.COM_FILE_P1.uint32 = COM_FILE_DATA;
+    pFrame->cfg.COM_FILE_P4.uint32 = crc32(pChunk, bytesToRead);
+    uint32_t length = bytesToRead;
+    if (state.compress == true) {
+        // send compressed only if it is shorter .. the chunk size fits the frame uncompressed anyway
+        size_t compressedLength = lzfCompress(pChunk, bytesToRead, pData, bytesToRead - 1, _lzfTable);
+        if (compressedLength > 0) {
+            pFrame->cfg.COM_FILE_P1.uint32 = COM_FILE_DATA_LZF;
+            length = compressedLength;
+        } else {
+            memcpy(pData, pChunk, bytesToRead);
+        }
+    }
+    if (state.raw == true) {
+        pFrame->dataLength = length;
+        pFrame->cfg.str.clear();
+    } else {
+        char bufferBase64[COM_FRAME_MAX_STR_LENGTH];
+        encode_base64(buffer, length, (uint8_t *)bufferBase64);
+        pFrame->cfg.str = bufferBase64;
+    }
+    pFrame->res = "";
+    return true;
+}
+
+// crc32 over the first length bytes of the open transfer file
+// decodes the base64 text of one chunk into pBuffer (MAX_FILE_CHUNK_SIZE bytes), 0: error (res is set)
+size_t LittleFsCOM::_decodeChunk(ComFrame *pFrame, uint8_t * pBuffer) {
+    const uint8_t * pText = (const uint8_t *)pFrame->cfg.str.c_str();
+    size_t textLength = pFrame->cfg.str.length();
+    if ((textLength > MAX_FILE_CHUNK_BASE64_LENGTH) || (decode_base64_length(pText, textLength) > MAX_FILE_CHUNK_SIZE)) {
+        pFrame->res = "Error: Chunk too long.";
+        return 0;
+    }
+    size_t decodedLength = decode_base64(pText, textLength, pBuffer);
+    if (decodedLength == 0) {
+        pFrame->res = "Error: Base64 decode failed.";
+    }
+    return decodedLength;
+}
+
+bool LittleFsCOM::_crcOfFile(uint32_t length, uint32_t & crc) {
+    uint8_t buffer[MAX_FILE_CHUNK_SIZE];
+    uint32_t offset = 0;
+
+    crc = 0;
+    while (offset < length) {
+        size_t part = min((uint32_t)sizeof(buffer), length - offset);
+        if (_fileTransferState.readAt(offset, buffer, part) != part) {
+            return false;
+        }
+        crc = crc32(buffer, part, crc);
+        offset += part;
+    }
+    return true;
+}
+
+// all chunks written: check size (and crc32 from P4) of <file>.part, then replace the target file
+bool LittleFsCOM::_finishWrite(ComFrame *pFrame, bool checkCrc) {
+    FileTransferState & state = _fileTransferState;
+    String partName = state.partName();
+
+    // reopen for reading (the part file may be write only)
+    fsStatCache.invalidate();
+    state.file.close();
+    state.basis.close();
+    state.isWrite = false;
+    state.file = LittleFS.open(partName, "r");
+    if (!state.file) {
+        pFrame->res = "Error: Failed to read file: " + partName;
+        state.reset();
+        return false;
+    }
+
+    uint32_t crc = 0;
+    if (state.file.size() != state.fileSize) {
+        pFrame->res = "Error: File size mismatch: " + String((uint32_t)state.file.size());
+        state.reset();
+        LittleFS.remove(partName);
+        return false;
+    }
+    if ((checkCrc == true) && ((_crcOfFile(state.fileSize, crc) == false) || (crc != pFrame->cfg.COM_FILE_P4.uint32))) {
+        pFrame->res = "Error: File crc mismatch.";
+        pFrame->cfg.COM_FILE_P4.uint32 = crc;
+        state.reset();
+        LittleFS.remove(partName);
+        return false;
+    }
+    if (state.bundle == true) {
+        return _unpackBundle(pFrame);
+    }
+    state.file.close();
+
+    // littlefs replaces an existing target atomically .. the old file stays if the rename fails
+    if (!LittleFS.rename(partName, state.filename)) {
+        pFrame->res = "Error: Failed to rename " + partName;
+        state.reset();
+        LittleFS.remove(partName);
+        return false;
+    }
+
+    fsStatCache.invalidate();
+    state.reset();
+    pFrame->res = "File write completed.";
+    return true;
+}
+
+// P2 block size (0: default) .. 0 for an invalid size
+static uint32_t hashBlockSize(uint32_t blockSize) {
+    if (blockSize == 0) {
+        return COM_FILE_HASH_BLOCK_SIZE;
+    }
+    if ((blockSize < COM_FILE_HASH_MIN_BLOCK_SIZE) || (blockSize > COM_FILE_HASH_MAX_BLOCK_SIZE)) {
+        return 0;
+    }
+    return blockSize;
+}
+
+// checksums of all blocks of a file (streamed): one line "<adler32> <crc32>" per block, last line "crc32 <crc32 of the file>"
+// answer P2 block size, P3 number of blocks, P4 file size
+bool LittleFsCOM::_hashFile(ComFrame *pFrame) {
+    String filename = pFrame->cfg.str.c_str();
+    uint32_t blockSize = hashBlockSize(pFrame->cfg.COM_FILE_P2.uint32);
+
+    if (blockSize == 0) {
+        pFrame->res = "Error: block size out of range (" + String(COM_FILE_HASH_MIN_BLOCK_SIZE) + ".." + String(COM_FILE_HASH_MAX_BLOCK_SIZE) + ").";
+        return false;
+    }
+    File file = LittleFS.open(filename, "r");
+    if (!file) {
+        pFrame->res = "Error: File not found: " + filename;
+        return false;
+    }
+
+    uint32_t fileSize = file.size();
+    pFrame->cfg.COM_FILE_P2.uint32 = blockSize;
+    pFrame->cfg.COM_FILE_P3.uint32 = (fileSize + blockSize - 1) / blockSize;
+    pFrame->cfg.COM_FILE_P4.uint32 = fileSize;
+
+    uint8_t buffer[MAX_FILE_CHUNK_SIZE];
+    uint32_t offset = 0;
+    uint32_t fileCrc = 0;
+    char line[24];
+    while (offset < fileSize) {
+        uint32_t blockEnd = min(offset + blockSize, fileSize);
+        uint32_t adler = 1;
+        uint32_t crc = 0;
+        while (offset < blockEnd) {
+            size_t part = min((uint32_t)sizeof(buffer), blockEnd - offset);
+            if (file.read(buffer, part) != part) {
+                file.close();
+                pFrame->res = "Error: Failed to read file: " + filename;
+                return false;
+            }
+            adler   = adler32(buffer, part, adler);
+            crc     = crc32(buffer, part, crc);
+            fileCrc = crc32(buffer, part, fileCrc);
+            offset += part;
+        }
+        snprintf(line, sizeof(line), "%08lX %08lX\n", (unsigned long)adler, (unsigned long)crc);
+        pFrame->out->print(line);
+    }
+    file.close();
+
+    snprintf(line, sizeof(line), "crc32 %08lX\n", (unsigned long)fileCrc);
+    pFrame->out->print(line);
+    return true;
+}
+
+// delta update of a file with the block checksums of FILE hash, see README
+// INIT (str file, P2 block size, P4 new file size), COPY blocks of the old file / DATA literal bytes, FINISH (P4 crc32 of the new file)
+bool LittleFsCOM::_patchFile(ComFrame *pFrame) {
+    FileTransferState & state = _fileTransferState;
+    uint32_t sequenz = pFrame->cfg.COM_FILE_P1.uint32;
+
+    if (sequenz == COM_FILE_INIT) {
+        state.reset();
+        state.filename = pFrame->cfg.str.c_str();
+        state.chunkSize = hashBlockSize(pFrame->cfg.COM_FILE_P2.uint32);
+        state.fileSize = pFrame->cfg.COM_FILE_P4.uint32;
+        if (state.chunkSize == 0) {
+            pFrame->res = "Error: block size out of range (" + String(COM_FILE_HASH_MIN_BLOCK_SIZE) + ".." + String(COM_FILE_HASH_MAX_BLOCK_SIZE) + ").";
+            state.reset();
+            return false;
+        }
+
+        state.basis = LittleFS.open(state.filename, "r");
+        if (!state.basis) {
+            pFrame->res = "Error: File not found: " + state.filename;
+            state.reset();
+            return false;
+        }
+        // the new version is built in <file>.part, FINISH replaces the old file
+        state.file = LittleFS.open(state.partName(), "w");
+        fsStatCache.invalidate();
+        if (!state.file) {
+            pFrame->res = "Error: Failed to create new file: " + state.partName();
+            state.reset();
+            return false;
+        }
+        state.isActive = true;
+        state.isWrite = true;
+        state.patch = true;
+        state.lastAccess = millis();
+
+        pFrame->cfg.COM_FILE_P2.uint32 = state.chunkSize;
+        pFrame->res = "";
+        return true;
+    }
+
+    if ((state.isActive == false) || (state.patch == false)) {
+        pFrame->res = "Error: No active file patch sequence.";
+        return false;
+    }
+    if (sequenz == COM_FILE_COPY) {
+        return _patchCopy(pFrame);
+    } else if (sequenz == COM_FILE_DATA) {
+        return _patchLiteral(pFrame);
+    } else if (sequenz == COM_FILE_FINISH) {
+        return _finishWrite(pFrame, true);
+    }
+
+    pFrame->res = "Error: Invalid sequence id P1:" + String(sequenz, HEX);
+    state.reset();
+    return false;
+}
+
+// patch: append P3 blocks of the old file starting at block P2 (the last block of the old file can be shorter)
+// answer P4: size of the new file so far
+bool LittleFsCOM::_patchCopy(ComFrame *pFrame) {
+    FileTransferState & state = _fileTransferState;
+    uint32_t basisSize = state.basis.size();
+    uint32_t offset    = pFrame->cfg.COM_FILE_P2.uint32 * state.chunkSize;
+    uint32_t blocks    = pFrame->cfg.COM_FILE_P3.uint32;
+
+    if ((blocks == 0) || (offset >= basisSize) || (blocks > (basisSize - offset + state.chunkSize - 1) / state.chunkSize)) {
+        pFrame->res = "Error: Invalid block range.";
+        return false;
+    }
+    uint32_t end = min(offset + blocks * state.chunkSize, basisSize);
+    if (state.file.size() + (end - offset) > state.fileSize) {
+        pFrame->res = "Error: Patch exceeds file size.";
+        return false;
+    }
+
+    uint8_t buffer[MAX_FILE_CHUNK_SIZE];
+    if (state.basis.seek(offset) == false) {
+        pFrame->res = "Error: Failed to read file: " + state.filename;
+        state.reset();
+        return false;
+    }
+    while (offset < end) {
+        size_t part = min((uint32_t)sizeof(buffer), end - offset);
+        if ((state.basis.read(buffer, part) != part) || (state.file.write(buffer, part) != part)) {
+            pFrame->res = "Error: Failed to copy block of file: " + state.filename;
+            state.reset();
+            return false;
+        }
+        offset += part;
+    }
+
+    state.lastAccess = millis();
+    pFrame->cfg.COM_FILE_P4.uint32 = state.file.size();
+    pFrame->res = "";
+    return true;
+}
+
+// patch: append literal bytes (base64 in str or raw data of a binary frame), P4 crc32 of the bytes
+// answer P4: size of the new file so far
+bool LittleFsCOM::_patchLiteral(ComFrame *pFrame) {
+    FileTransferState & state = _fileTransferState;
+    uint8_t buffer[MAX_FILE_CHUNK_SIZE];
+    const uint8_t * pData = buffer;
+    size_t length;
+
+    if (pFrame->dataLength > 0) {
+        pData = pFrame->data;
+        length = pFrame->dataLength;
+        pFrame->dataLength = 0;         // answer without data
+    } else {
+        length = _decodeChunk(pFrame, buffer);
+        if (length == 0) {
+            return false;
+        }
+    }
+    if (crc32(pData, length) != pFrame->cfg.COM_FILE_P4.uint32) {
+        pFrame->res = "Error: Chunk crc mismatch.";
+        return false;
+    }
+    if (state.file.size() + length > state.fileSize) {
+        pFrame->res = "Error: Patch exceeds file size.";
+        return false;
+    }
+    if (state.file.write(pData, length) != length) {
+        pFrame->res = "Error: Failed to write to file: " + state.filename;
+        state.reset();
+        return false;
+    }
+
+    state.lastAccess = millis();
+    pFrame->cfg.COM_FILE_P4.uint32 = state.file.size();
+    pFrame->cfg.str.clear();            // no echo of the data
+    pFrame->res = "";
+    return true;
+}
+
+// bundle complete and checked: unpack all entries of <file>.part, then remove it
+// answer P3 number of entries, P4 bytes written
+bool LittleFsCOM::_unpackBundle(ComFrame *pFrame) {
+    FileTransferState & state = _fileTransferState;
+    String partName = state.partName();
+    BundleUnpacker unpacker;
+    uint8_t buffer[MAX_FILE_CHUNK_SIZE];
+    uint32_t offset = 0;
+    bool res = true;
+
+    unpacker.begin();
+    while ((res == true) && (offset < state.fileSize)) {
+        size_t part = min((uint32_t)sizeof(buffer), state.fileSize - offset);
+        if (state.readAt(offset, buffer, part) != part) {
+            unpacker.error = "Error: Failed to read file: " + partName;
+            res = false;
+            break;
+        }
+        res = unpacker.feed(buffer, part);
+        offset += part;
+    }
+    if (res == true) {
+        res = unpacker.end();
+    }
+
+    state.reset();
+    LittleFS.remove(partName);
+    fsStatCache.invalidate();
+
+    pFrame->cfg.COM_FILE_P3.uint32 = unpacker.entries;
+    pFrame->cfg.COM_FILE_P4.uint32 = unpacker.bytesWritten;
+    if (res == false) {
+        pFrame->res = unpacker.error;
+        return false;
+    }
+    pFrame->res = "Bundle unpacked: " + String(unpacker.entries) + " entries.";
+    return true;
+}
+
+void BundleUnpacker::begin() {
+    entries = 0;
+    bytesWritten = 0;
+    error = "";
+    _state = MAGIC;
+    _count = 0;
+    _file.close();
+}
+
+bool BundleUnpacker::feed(const uint8_t * p, size_t length) {
+    while (length > 0) {
+        switch (_state) {
+            case MAGIC:
+                if (*p != (uint8_t)COM_BUNDLE_MAGIC[_count]) {
+                    return _fail("Error: not a bundle.");
+                }
+                if (++_count == COM_BUNDLE_MAGIC_LENGTH) {
+                    _state = TYPE;
+                }
+                break;
+
+            case TYPE:
+                _type = *p;
+                if ((_type < COM_BUNDLE_FILE) || (_type > COM_BUNDLE_REMOVE)) {
+                    return _fail("Error: invalid bundle entry type " + String(_type) + ".");
+                }
+                _state = PATH_LENGTH;
+                break;
+
+            case PATH_LENGTH:
+                _pathLength = *p;
+                _count = 0;
+                if (_pathLength == 0) {
+                    return _fail("Error: empty path in bundle.");
+                }
+                _state = PATH;
+                break;
+
+            case PATH:
+                _path[_count++] = *p;
+                if ((_count == _pathLength) && (_pathDone() == false)) {
+                    return false;
+                }
+                break;
+
+            case SIZE:
+                _remaining |= (uint32_t)*p << (8 * _count);
+                if (++_count == sizeof(uint32_t)) {
+                    _file = LittleFS.open(_path, "w");
+                    if (!_file) {
+                        return _fail("Error: Failed to create new file: " + String(_path));
+                    }
+                    _state = DATA;
+                    if (_remaining == 0) {
+                        _file.close();
+                        entries++;
+                        _state = TYPE;
+                    }
+                }
+                break;
+
+            case DATA: {
+                // bulk copy of the file data
+                size_t part = min((uint32_t)length, _remaining);
+                if (_file.write(p, part) != part) {
+                    return _fail("Error: Failed to write to file: " + String(_path));
+                }
+                bytesWritten += part;
+                _remaining -= part;
+                p += part;
+                length -= part;
+                if (_remaining == 0) {
+                    _file.close();
+                    entries++;
+                    _state = TYPE;
+                }
+                continue;
+            }
+        }
+        p++;
+        length--;
+    }
+    return true;
+}
+
+bool BundleUnpacker::end() {
+    if (_state != TYPE) {
+        return _fail("Error: bundle incomplete.");
+    }
+    return true;
+}
+
+// complete path of an entry received .. directory and remove entries are done now, files need size and data
+bool BundleUnpacker::_pathDone() {
+    _path[_pathLength] = 0;
+    String path = _path;
+    if (_path[0] != '/') {
+        return _fail("Error: bundle path must be absolute: " + path);
+    }
+
+    if (_type == COM_BUNDLE_FILE) {
+        _state = SIZE;
+        _count = 0;
+        _remaining = 0;
+        return true;
+    }
+
+    if (_type == COM_BUNDLE_DIRECTORY) {
+        // like FILE mkdir: LittleFS does not support empty directories
+        if (LittleFS.exists(path) == false) {
+            File file = LittleFS.open(path + "/.keep", "w");
+            if (!file) {
+                return _fail("Error: Failed to create directory: " + path);
+            }
+            file.close();
+        }
+    } else if (LittleFS.exists(path) && (LittleFS.remove(path) == false)) {
+        // not a file: remove the directory with all files and subdirectories
+        _removeTree(path);
+        if (LittleFS.exists(path)) {
+            return _fail("Error: Failed to remove: " + path);
+        }
+    }
+    entries++;
+    _state = TYPE;
+    return true;
+}
+
+// a partly written file of the broken entry is removed, all entries before stay unpacked
+bool BundleUnpacker::_fail(const String& text) {
+    error = text;
+    if (_file) {
+        _file.close();
+        LittleFS.remove(_path);
+    }
+    return false;
+}
+
+// LittleFS removes a directory with its last file
+void BundleUnpacker::_removeTree(const String& path) {
+    Dir dir = LittleFS.openDir(path);
+    while (dir.next()) {
+        String entry = path + "/" + dir.fileName();
+        if (dir.isDirectory()) {
+            _removeTree(entry);
+        } else {
+            LittleFS.remove(entry);
+        }
+    }
+    LittleFS.rmdir(path);
+}
+
+// str "<source>~&~<target>" .. source has to exist, target only with overwrite flag (P2 bit0)
+bool LittleFsCOM::_twoPaths(ComFrame *pFrame, String & source, String & target) {
+    String paths = pFrame->cfg.str.c_str();
+    Split split(paths, (char *)COM_FILE_PATH_SEPARATOR);
+
+    source = split.getNextListEntry();
+    target = split.getNextListEntry();
+    source.trim();
+    target.trim();
+    if ((source.length() == 0) || (target.length() == 0) || (source == target)) {
+        pFrame->res = "Error: expected \"<source>~&~<target>\".";
+        return false;
+    }
+    if (!LittleFS.exists(source)) {
+        pFrame->res = "Error: File not found: " + source;
+        return false;
+    }
+    if (LittleFS.exists(target)) {
+        if ((pFrame->cfg.COM_FILE_P2.uint32 & COM_FILE_OVERWRITE) == 0) {
+            pFrame->res = "Error: Target exists: " + target;
+            return false;
+        }
+    }
+    return true;
+}
+
+// copy via <target>.part .. the old target is replaced only after a complete copy
+bool LittleFsCOM::_copyFile(ComFrame *pFrame) {
+    String source, target;
+    if (_twoPaths(pFrame, source, target) == false) {
+        return false;
+    }
+
+    String partName = target + COM_FILE_PART_EXTENSION;
+    File in = LittleFS.open(source, "r");
+    if (in && in.isDirectory()) {
+        pFrame->res = "Error: Source is a directory: " + source;
+        in.close();
+        return false;
+    }
+    File out = LittleFS.open(partName, "w");
+    fsStatCache.invalidate();
+    if (!in || !out) {
+        pFrame->res = "Error: Failed to open " + String(!in ? source : partName);
+        in.close();
+        out.close();
+        LittleFS.remove(partName);
+        return false;
+    }
+
+    uint8_t buffer[MAX_FILE_CHUNK_SIZE];
+    uint32_t size = in.size();
+    uint32_t offset = 0;
+    while (offset < size) {
+        size_t part = min((uint32_t)sizeof(buffer), size - offset);
+        if ((in.read(buffer, part) != part) || (out.write(buffer, part) != part)) {
+            break;
+        }
+        offset += part;
+    }
+    in.close();
+    out.close();
+
+    if (offset != size) {
+        pFrame->res = "Error: Failed to copy " + source;
+        LittleFS.remove(partName);
+        return false;
+    }
+    // littlefs replaces an existing target atomically .. the old file stays if the rename fails
+    if (!LittleFS.rename(partName, target)) {
+        pFrame->res = "Error: Failed to rename " + partName;
+        LittleFS.remove(partName);
+        return false;
+    }
+    pFrame->cfg.COM_FILE_P4.uint32 = size;
+    return true;
+}
+
+bool LittleFsCOM::_moveFile(ComFrame *pFrame) {
+    String source, target;
+    if (_twoPaths(pFrame, source, target) == false) {
+        return false;
+    }
+
+    fsStatCache.invalidate();
+    if (!LittleFS.rename(source, target)) {
+        pFrame->res = "Error: Failed to rename " + source;
+        return false;
+    }
+    return true;
+}
+
+// last P2 bytes (P3 = 0) or lines (P3 = 1) of a file (streamed)
+// answer P2 offset of the first byte sent, P4 file size
+bool LittleFsCOM::_tailFile(ComFrame *pFrame) {
+    String filename = pFrame->cfg.str.c_str();
+    uint32_t count = pFrame->cfg.COM_FILE_P2.uint32;
+    uint32_t unit  = pFrame->cfg.COM_FILE_P3.uint32;
+
+    if (unit > COM_FILE_TAIL_LINES) {
+        pFrame->res = "Error: invalid unit P3 (0: bytes, 1: lines).";
+        return false;
+    }
+    File file = LittleFS.open(filename, "r");
+    if (!file) {
+        pFrame->res = "Error: File not found: " + filename;
+        return false;
+    }
+
+    uint8_t buffer[MAX_FILE_CHUNK_SIZE];
+    uint32_t size = file.size();
+    uint32_t start;
+    if (unit == COM_FILE_TAIL_BYTES) {
+        count = (count == 0) ? COM_FILE_TAIL_DEFAULT_BYTES : count;
+        start = (count < size) ? size - count : 0;
+    } else {
+        // search backwards for the newline in front of the last count lines (a newline at the end of the file does not start a line)
+        count = (count == 0) ? COM_FILE_TAIL_DEFAULT_LINES : count;
+        uint32_t end = (size > 0) ? size - 1 : 0;
+        start = 0;
+        while ((end > 0) && (count > 0)) {
+            uint32_t blockStart = (end > sizeof(buffer)) ? end - sizeof(buffer) : 0;
+            size_t part = end - blockStart;
+            if ((file.seek(blockStart) == false) || (file.read(buffer, part) != part)) {
+                file.close();
+                pFrame->res = "Error: Failed to read file: " + filename;
+                return false;
+            }
+            while ((part > 0) && (count > 0)) {
+                part--;
+                if ((buffer[part] == '\n') && (--count == 0)) {
+                    start = blockStart + part + 1;
+                }
+            }
+            end = blockStart;
+        }
+    }
+
+    uint32_t offset = start;
+    if (file.seek(start) == false) {
+        file.close();
+        pFrame->res = "Error: Failed to read file: " + filename;
+        return false;
+    }
+    while (offset < size) {
+        size_t part = min((uint32_t)sizeof(buffer), size - offset);
+        if (file.read(buffer, part) != part) {
+            break;
+        }
+        pFrame->out->write(buffer, part);
+        offset += part;
+    }
+    file.close();
+
+    pFrame->cfg.COM_FILE_P2.uint32 = start;
+    pFrame->cfg.COM_FILE_P4.uint32 = size;
+    if (offset != size) {
+        pFrame->res = "Error: Failed to read file: " + filename;
+        return false;
+    }
+    return true;
+}
+
 bool LittleFsCOM::_deleteFile(ComFrame *pFrame) {
-    String filePath = pFrame->cfg.str;
+    String filePath = pFrame->cfg.str.c_str();
 
     if (!LittleFS.exists(filePath)) {
         pFrame->res = "Error: File does not exist.";
@@ -205,6 +1137,7 @@ bool LittleFsCOM::_deleteFile(ComFrame *pFrame) {
     }
 
     if (LittleFS.remove(filePath)) {
+        fsStatCache.invalidate();
         return true;
     }
 
@@ -213,7 +1146,7 @@ bool LittleFsCOM::_deleteFile(ComFrame *pFrame) {
 }
 
 bool LittleFsCOM::_createDirectory(ComFrame *pFrame) {
-    String path = pFrame->cfg.str;
+    String path = pFrame->cfg.str.c_str();
 
     if (LittleFS.exists(path)) {
         pFrame->res = "Error: Path already exists.";
@@ -222,6 +1155,7 @@ bool LittleFsCOM::_createDirectory(ComFrame *pFrame) {
 
     // LittleFS does not support creating empty directories directly
     File file = LittleFS.open(path + "/.keep", "w");
+    fsStatCache.invalidate();
     if (!file) {
         pFrame->res = "Error: Failed to create directory.";
         return false;
@@ -232,13 +1166,14 @@ bool LittleFsCOM::_createDirectory(ComFrame *pFrame) {
 }
 
 bool LittleFsCOM::_deleteDirectory(ComFrame *pFrame) {
-    String path = pFrame->cfg.str;
+    String path = pFrame->cfg.str.c_str();
 
     if (!LittleFS.exists(path)) {
         pFrame->res = "Error: Path does not exist.";
         return false;
     }
 
+    fsStatCache.invalidate();
     Dir dir = LittleFS.openDir(path);
     while (dir.next()) {
         if (!LittleFS.remove(path + "/" + dir.fileName())) {
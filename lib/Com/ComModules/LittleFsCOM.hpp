@@ -2,22 +2,89 @@
 #pragma once
 #include "ComModule.hpp"
 #include <LittleFS.h>
+#include <FsStatCache.hpp>
+#include <CoreLock.hpp>
+#include <helper.h>
 
 
+// an open transfer is closed if the host does not send the next frame within this time
+#ifndef COM_FILE_TRANSFER_TIMEOUT_MS
+#define COM_FILE_TRANSFER_TIMEOUT_MS    10000
+#endif
+
+#define COM_FILE_PART_EXTENSION         ".part"     // a write goes to <file>.part first
+
 class FileTransferState {
     public:
+        // the file stays open for the whole transfer .. each chunk is a plain sequential read/write
+        File file;
+        File basis;                     // patch: old version of the file, source of the COPY blocks
+        uint32_t lastAccess = 0;        // [ms] for timeout
         String filename;
         uint32_t fileSize = 0;
         uint32_t totalChunks = 0;
-        uint32_t currentChunk = 0;
+        uint32_t currentChunk = 0;      // stop and wait: next expected chunk / windowed: first missing chunk
         bool isActive = false;
+
+        // windowed / raw transfer: chunks with offset (see README)
+        bool     useOffsets = false;
+        bool     raw = false;           // raw data in ComFrame::data instead of base64 in str (binary frames)
+        bool     resume = false;        // write: continue an existing <file>.part
+        bool     compress = false;      // LZF compressed chunks (COM_FILE_DATA_LZF) allowed
+        bool     bundle = false;        // write: archive, unpacked at FINISH instead of rename
+        bool     isWrite = false;
+        bool     patch = false;         // FILE patch sequence (chunkSize: block size of FILE hash)
+        uint8_t  windowSize = 1;
+        uint16_t chunkSize = 128;
+        uint32_t windowBitmap = 0;      // bit i: chunk currentChunk+i received
     
         void reset() {
+            if (file) {
+                if (isWrite == true) {
+                    fsStatCache.invalidate();
+                }
+                if ((isWrite == true) && (resume == true)) {
+                    // interrupted write: keep only the chunks without gap, so a resume can trust the <file>.part
+                    file.truncate((currentChunk - 1) * chunkSize);
+                }
+                file.close();
+                if ((isWrite == true) && (resume == false)) {
+                    // aborted write without resume: nobody will continue the <file>.part
+                    LittleFS.remove(partName());
+                }
+            }
+            if (basis) {
+                basis.close();
+            }
+            lastAccess = 0;
             filename = "";
             fileSize = 0;
             totalChunks = 0;
             currentChunk = 0;
             isActive = false;
+            useOffsets = false;
+            raw = false;
+            resume = false;
+            compress = false;
+            bundle = false;
+            isWrite = false;
+            patch = false;
+            windowSize = 1;
+            chunkSize = 128;
+            windowBitmap = 0;
+        }
+
+        String partName() const { return filename + COM_FILE_PART_EXTENSION; }
+
+        // seek only if the position differs (out of order chunks of a windowed transfer)
+        size_t readAt(uint32_t offset, uint8_t * pBuffer, size_t length) {
+            if ((file.position() != offset) && (file.seek(offset) == false)) return 0;
+            return file.read(pBuffer, length);
+        }
+
+        size_t writeAt(uint32_t offset, const uint8_t * pBuffer, size_t length) {
+            if ((file.position() != offset) && (file.seek(offset) == false)) return 0;
+            return file.write(pBuffer, length);
         }
     };
 
@@ -27,25 +94,115 @@ class FileTransferState {
 #define COM_FILE_P4 par3
 
 #define COM_FILE_INIT   0x00
+#define COM_FILE_COPY   0x0C    // patch: copy P3 blocks of the old file starting at block P2
 #define COM_FILE_DATA   0x0D
+#define COM_FILE_DATA_LZF 0x0E  // data chunk LZF compressed (only with COM_FILE_FLAG_COMPRESS)
+#define COM_FILE_FINISH 0x0F    // check file crc32 (P4), then replace the file (write) / return size and crc32 (read)
 #define MAX_FILE_CHUNK_SIZE 128 // Maximum file chunk size for splitting.
+#define MAX_FILE_CHUNK_BASE64_LENGTH (4 * ((MAX_FILE_CHUNK_SIZE + 2) / 3))  // base64 text of one chunk
+
+// INIT frame P2: transfer options (0 or window size 1 = stop and wait as before)
+#define COM_FILE_WINDOW_MASK        0x000000FF  // bits  7..0  window size [chunks]
+#define COM_FILE_FLAGS_MASK         0x0000FF00  // bits 15..8  transfer flags
+#define COM_FILE_CHUNK_SIZE_SHIFT   16          // bits 31..16 chunk size [bytes] (0: MAX_FILE_CHUNK_SIZE)
+#define COM_FILE_MAX_WINDOW         32          // size of the selective ack bitmap
+
+#define COM_FILE_FLAG_RAW           0x00000100  // raw data chunks (binary frames only)
+#define COM_FILE_FLAG_RESUME        0x00000200  // write: continue <file>.part of an interrupted transfer
+#define COM_FILE_FLAG_COMPRESS      0x00000400  // chunks can be LZF compressed (per chunk, P4 crc32 of the uncompressed data)
+#define COM_FILE_FLAG_BUNDLE        0x00000800  // write: the file is an archive of several entries, unpacked at FINISH
+#define COM_FILE_MAX_RAW_CHUNK_SIZE COM_FRAME_MAX_DATA_LENGTH
+
+// bundle archive (COM_FILE_FLAG_BUNDLE): magic, then entries <type u8><path length u8><path>[<size u32><data>] (little endian)
+#define COM_BUNDLE_MAGIC                "PFB1"
+#define COM_BUNDLE_MAGIC_LENGTH         4
+#define COM_BUNDLE_FILE                 0x01    // path, size, data .. an existing file is replaced
+#define COM_BUNDLE_DIRECTORY            0x02    // path
+#define COM_BUNDLE_REMOVE               0x03    // path of a file or a directory (incl. its files)
+
+// streaming unpacker of a bundle .. the archive can be fed in pieces of any size
+class BundleUnpacker {
+    public:
+        void begin();
+        bool feed(const uint8_t * p, size_t length);   // false: error (see error)
+        bool end();                                     // false: archive incomplete
+
+        uint32_t entries = 0;
+        uint32_t bytesWritten = 0;
+        String   error;
+
+    private:
+        enum State {MAGIC, TYPE, PATH_LENGTH, PATH, SIZE, DATA};
+
+        bool _pathDone();
+        static void _removeTree(const String& path);
+        bool _fail(const String& text);
+
+        State    _state = MAGIC;
+        uint8_t  _type = 0;
+        uint8_t  _count = 0;            // bytes of magic / path / size received
+        uint8_t  _pathLength = 0;
+        char     _path[256];
+        uint32_t _remaining = 0;        // data bytes of the current file
+        File     _file;
+};
+
+// FILE ls: entries per page (P3, 0: default)
+#define COM_FILE_LIST_PAGE_SIZE         8
+#define COM_FILE_LIST_MAX_PAGE_SIZE     32
+
+// FILE copy / FILE move: str "<source>~&~<target>", P2 bit0 overwrite an existing target
+#define COM_FILE_PATH_SEPARATOR         "~&~"
+#define COM_FILE_OVERWRITE              0x01
+
+// FILE tail: P2 count (0: default), P3 unit
+#define COM_FILE_TAIL_BYTES             0
+#define COM_FILE_TAIL_LINES             1
+#define COM_FILE_TAIL_DEFAULT_BYTES     512
+#define COM_FILE_TAIL_DEFAULT_LINES     10
+
+// FILE hash / FILE patch: block size of the checksums (P2, 0: default)
+#define COM_FILE_HASH_BLOCK_SIZE        512
+#define COM_FILE_HASH_MIN_BLOCK_SIZE    64
+#define COM_FILE_HASH_MAX_BLOCK_SIZE    8192
 
 
 
 
 class LittleFsCOM : public ComModule {
 public:
-    LittleFsCOM() : ComModule('F') {LittleFS.begin();}
+    LittleFsCOM();
+    void loop(uint32_t now) override;       // closes an abandoned transfer (COM_FILE_TRANSFER_TIMEOUT_MS)
 
-    bool dispatchFrame(ComFrame* pFrame) override;
-    
 private:
-    String _listDirectory(String path, String header);
+    bool _idle(ComFrame *pFrame, const FsLock& lock);
+    bool _list(ComFrame *pFrame);
+    bool _listPage(ComFrame *pFrame);
+    static void _printEntry(Print * pOut, const FsStatEntry& entry);
     bool _readFile(ComFrame *pFrame);
     bool _writeFile(ComFrame *pFrame);
+    bool _hashFile(ComFrame *pFrame);
+    bool _patchFile(ComFrame *pFrame);
+    bool _patchCopy(ComFrame *pFrame);
+    bool _patchLiteral(ComFrame *pFrame);
+    bool _copyFile(ComFrame *pFrame);
+    bool _moveFile(ComFrame *pFrame);
+    bool _twoPaths(ComFrame *pFrame, String & source, String & target);
+    bool _tailFile(ComFrame *pFrame);
     bool _deleteFile(ComFrame *pFrame);
     bool _createDirectory(ComFrame *pFrame);
+    bool _initWindow(ComFrame *pFrame);
+    bool _writeChunkWindowed(ComFrame *pFrame);
+    bool _readChunkWindowed(ComFrame *pFrame);
+    bool _finishWrite(ComFrame *pFrame, bool checkCrc);
+    bool _crcOfFile(uint32_t length, uint32_t & crc);
+    size_t _decodeChunk(ComFrame *pFrame, uint8_t * pBuffer);
+    bool _unpackBundle(ComFrame *pFrame);
     bool _deleteDirectory(ComFrame *pFrame);
 
     FileTransferState _fileTransferState;
+
+    // LZF: uncompressed chunk and hash table of the compressor
+    uint8_t  _lzfBuffer[COM_FILE_MAX_RAW_CHUNK_SIZE];
+    uint16_t _lzfTable[LZF_HASH_SIZE];
 };
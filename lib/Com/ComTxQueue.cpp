@@ -0,0 +1,104 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 MonkeyCodeMen@GitHub
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * provided to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include <ComTxQueue.hpp>
+#include <Debug.hpp>
+
+ComTxQueue::ComTxQueue(size_t size) :
+    bytesSent(0), droppedBytes(0), highWater(0),
+    _pPort(nullptr), _size(size), _read(0), _count(0)
+{
+    _pBuffer = new uint8_t[_size];
+    if (_pBuffer == NULL){
+        STOP(F("not enough memory for COM TX queue"));
+    }
+}
+
+ComTxQueue::~ComTxQueue() {
+    delete[] _pBuffer;
+}
+
+size_t ComTxQueue::write(uint8_t value) {
+    return write(&value, 1);
+}
+
+size_t ComTxQueue::write(const uint8_t * pBuffer, size_t size) {
+    if (size > free()) {
+        drain();
+    }
+
+    size_t written = 0;
+    while ((written < size) && (_count < _size)) {
+        size_t pos   = (_read + _count) % _size;
+        size_t part  = min(size - written, min(_size - _count, _size - pos));
+        memcpy(&_pBuffer[pos], &pBuffer[written], part);
+        _count  += part;
+        written += part;
+    }
+    if (_count > highWater) {
+        highWater = _count;
+    }
+    droppedBytes += size - written;
+    return written;
+}
+
+void ComTxQueue::drain() {
+    if (_pPort == nullptr) return;
+
+    while (_count > 0) {
+        int room = _pPort->availableForWrite();
+        if ((room <= 0) || (_send(room) == 0)) {
+            return;
+        }
+    }
+}
+
+bool ComTxQueue::reserve(size_t needed, uint32_t budget_us) {
+    if (free() >= needed) return true;
+    if ((_pPort == nullptr) || (needed > _size)) return false;
+
+    uint32_t start = micros();
+    while (free() < needed) {
+        if ((micros() - start) >= budget_us) {
+            return false;
+        }
+        int room = _pPort->availableForWrite();
+        if ((room > 0) && (_send(room) == 0)) {
+            return false;               // port takes nothing (closed) .. waiting is useless
+        }
+    }
+    return true;
+}
+
+// hand over up to room bytes (one part of the ring) .. returns the bytes the port took
+size_t ComTxQueue::_send(size_t room) {
+    size_t part = min(room, min(_count, _size - _read));
+    size_t sent = _pPort->write(&_pBuffer[_read], part);
+    _read   = (_read + sent) % _size;
+    _count -= sent;
+    bytesSent += sent;
+    return sent;
+}
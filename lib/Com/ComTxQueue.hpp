@@ -0,0 +1,72 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 MonkeyCodeMen@GitHub
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * provided to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#pragma once
+#include <Arduino.h>
+
+/*
+    transmit queue of the COM interface
+
+    answers are printed into a ring buffer (no blocking on the serial port) and
+    drain() hands over as many bytes as the port accepts without blocking (availableForWrite).
+    drain() must be called cyclic (Com::loop does this).
+
+    write() never waits for the port: bytes that do not fit into the free space are dropped
+    (short write, counted in droppedBytes). Com checks the room with reserve() before an answer is written,
+    reserve() waits for the port, but never longer than the given time budget and not at all if the
+    port does not take any byte (i.e. USB CDC with the host port closed).
+*/
+class ComTxQueue : public Print {
+public:
+    ComTxQueue(size_t size);
+    ~ComTxQueue();
+
+    void begin(Print * pPort)           { _pPort = pPort; }
+
+    size_t write(uint8_t value) override;
+    size_t write(const uint8_t * pBuffer, size_t size) override;
+    using Print::write;
+
+    void   drain();                     // non blocking
+    bool   reserve(size_t needed, uint32_t budget_us);     // true if needed bytes are free (waits at most budget_us)
+    size_t count() const                { return _count;            }
+    size_t free() const                 { return _size - _count;    }
+    size_t size() const                 { return _size;             }
+
+    // statistics
+    uint32_t bytesSent;                 // bytes handed over to the port
+    uint32_t droppedBytes;              // bytes that did not fit into the queue
+    uint32_t highWater;                 // max fill level
+
+private:
+    size_t _send(size_t room);
+
+    Print *   _pPort;
+    uint8_t * _pBuffer;
+    size_t    _size;
+    size_t    _read;
+    size_t    _count;
+};
@@ -0,0 +1,110 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 MonkeyCodeMen@GitHub
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * provided to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include "ComWorker.hpp"
+#include <Debug.hpp>
+
+ComWorker comWorker;
+
+// text a background handler prints to pFrame->out .. goes to res, because the answer stream is not available anymore
+class ComWorkerOut : public Print {
+public:
+    ComWorkerOut(String & res) : _res(res) {}
+    size_t write(uint8_t c) override { _res += (char)c; return 1; }
+    using Print::write;
+private:
+    String & _res;
+};
+
+ComWorker::ComWorker() : _pending(COM_WORKER_QUEUE_SIZE), _running(false) {
+    for (uint8_t i = 0; i < COM_WORKER_QUEUE_SIZE; i++) {
+        _jobs[i].state = JOB_FREE;
+    }
+}
+
+bool ComWorker::submit(ComFrame * pFrame, const ComCommandHandler_t * pHandler) {
+    if (_running == false) return false;
+
+    for (uint8_t i = 0; i < COM_WORKER_QUEUE_SIZE; i++) {
+        Job & job = _jobs[i];
+        if (job.state == JOB_FREE) {
+            job.pFrame   = pFrame;
+            job.pHandler = pHandler;
+            job.res      = false;
+            job.state    = JOB_RESERVED;
+            pFrame->deferred = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ComWorker::start(ComFrame * pFrame) {
+    for (uint8_t i = 0; i < COM_WORKER_QUEUE_SIZE; i++) {
+        Job & job = _jobs[i];
+        if ((job.state == JOB_RESERVED) && (job.pFrame == pFrame)) {
+            job.state = JOB_PENDING;
+            __sync_synchronize();       // job and frame complete before core0 can see it
+            _pending.push(&job);
+            return;
+        }
+    }
+}
+
+ComFrame * ComWorker::takeCompleted(Com * pLink, bool & res) {
+    for (uint8_t i = 0; i < COM_WORKER_QUEUE_SIZE; i++) {
+        Job & job = _jobs[i];
+        if ((job.state == JOB_DONE) && (job.pFrame->link == pLink)) {
+            __sync_synchronize();
+            ComFrame * pFrame = job.pFrame;
+            res = job.res;
+            job.state = JOB_FREE;
+            return pFrame;
+        }
+    }
+    return nullptr;
+}
+
+bool ComWorker::isIdle() const {
+    for (uint8_t i = 0; i < COM_WORKER_QUEUE_SIZE; i++) {
+        if ((_jobs[i].state == JOB_RESERVED) || (_jobs[i].state == JOB_PENDING)) return false;
+    }
+    return true;
+}
+
+void ComWorker::loop() {
+    Job * pJob;
+
+    _running = true;
+    while (_pending.pop(&pJob) == true) {
+        ComWorkerOut out(pJob->pFrame->res);
+        pJob->pFrame->out = &out;
+        pJob->res = (*pJob->pHandler)(pJob->pFrame);
+        pJob->pFrame->out = nullptr;
+        __sync_synchronize();
+        pJob->state = JOB_DONE;         // last write .. core1 takes the frame from now on
+    }
+}
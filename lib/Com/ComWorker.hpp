@@ -0,0 +1,92 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 MonkeyCodeMen@GitHub
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * provided to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <Arduino.h>
+#include <ComFrame.hpp>
+#include <ComModule.hpp>
+#include <RingBuffer.hpp>
+
+// number of background commands that can wait for / run in the worker at the same time (all links)
+#ifndef COM_WORKER_QUEUE_SIZE
+#define COM_WORKER_QUEUE_SIZE       4
+#endif
+
+class Com;
+
+/*
+    background execution of slow COM commands (flash write/erase of LittleFsCOM, ...)
+
+    Com runs in loop1() together with stripe.service(). A command registered with background = true
+    is not executed in the dispatch, the frame is deferred and handed to the worker instead:
+
+        core1  Com::loop        -> ComModule::dispatchFrame -> submit()      (frame deferred, job reserved)
+        core1  Com::frameDone   -> answer stream closed     -> start()       (job visible for core0)
+        core0  loop()           -> comWorker.loop()         -> handler runs
+        core1  Com::loop        -> takeCompleted()          -> answerDeferred()
+
+    so core1 keeps receiving and serving the LEDs while the handler works (CRC, compression, directory walks).
+    The flash erase/program itself still pauses core1: LittleFS stops the other core (idleOtherCore) during it.
+    Background handlers can not stream (pFrame->out collects the text in front of pFrame->res).
+    If the worker is not running (comWorker.loop() never called) or all jobs are busy, the command runs inline as before.
+*/
+class ComWorker {
+public:
+    ComWorker();
+    ~ComWorker() = default;
+
+    // core1 (COM link): reserve a job for a frame and mark it deferred .. false: not accepted, run it inline
+    bool submit(ComFrame * pFrame, const ComCommandHandler_t * pHandler);
+
+    // core1 (COM link): dispatch of the frame is finished (answer stream closed) .. core0 may run the job now
+    void start(ComFrame * pFrame);
+
+    // core1 (COM link): next finished frame of this link (nullptr: none), res: result of the handler
+    ComFrame * takeCompleted(Com * pLink, bool & res);
+
+    // core1: no job waiting or running .. state of the modules can be touched without race
+    bool isIdle() const;
+
+    // core0: run the waiting jobs
+    void loop();
+
+private:
+    enum JobState {JOB_FREE, JOB_RESERVED, JOB_PENDING, JOB_DONE};
+
+    struct Job {
+        ComFrame *                  pFrame;
+        const ComCommandHandler_t * pHandler;
+        bool                        res;
+        volatile JobState           state;
+    };
+
+    Job                 _jobs[COM_WORKER_QUEUE_SIZE];
+    RingBuffer<Job *>   _pending;       // core1 -> core0, holds all COM_WORKER_QUEUE_SIZE jobs (RingBuffer adds its free slot itself)
+    volatile bool       _running;
+};
+
+extern ComWorker comWorker;
@@ -1,6 +1,12 @@
 #pragma once
 
 #include <Arduino.h>
+#include <FixedString.hpp>
+
+// size of text parameter .. normally defined by ComFrame.hpp
+#ifndef COM_FRAME_MAX_STR_LENGTH
+#define COM_FRAME_MAX_STR_LENGTH        250
+#endif
 
 
 union cfgPar_u {
@@ -17,7 +23,7 @@ typedef union cfgPar_u cfgPar_t;
 
 class cfgPar{
 	public:
-    cfgPar (uint32_t p0=0,uint32_t p1=0,uint32_t p2=0,uint32_t p3=0,String str=""): 
+    cfgPar (uint32_t p0=0,uint32_t p1=0,uint32_t p2=0,uint32_t p3=0,const char * str=""): 
             par0{.uint32=p0},
             par1{.uint32=p1},
             par2{.uint32=p2},
@@ -32,7 +38,7 @@ class cfgPar{
 			par1.uint32  = 0;
 			par2.uint32  = 0; 
 			par3.uint32  = 0; 
-			str          = "";
+			str.clear();
 		}
 
 		virtual void operator=(const cfgPar & src){
@@ -71,5 +77,5 @@ class cfgPar{
         }
 
 		cfgPar_t    par0,par1,par2,par3;
-		String	 	str;
+		FixedString<COM_FRAME_MAX_STR_LENGTH> str;     // inline buffer .. no heap for text parameter
 };
\ No newline at end of file
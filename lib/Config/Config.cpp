@@ -2,55 +2,260 @@
 #include <Debug.hpp>
 #include <ArduinoJson.h>
 #include <helper.h>
+#include <FsStatCache.hpp>
 
-Config::Config(String filename, String objectName) : Dump(objectName), _filename(filename) {}
+// little endian fields of the journal and snapshot headers
+static void _putUint32(uint8_t * p, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+static uint32_t _getUint32(const uint8_t * p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// buffered Print into the config file .. size and crc32 of the written bytes are the fingerprint of the export
+class JsonFileWriter : public Print {
+public:
+    JsonFileWriter(File& file) : length(0), crc(0), failed(false), _file(file), _used(0) {}
+
+    size_t write(uint8_t value) override {
+        if (_used == sizeof(_buffer)) {
+            flush();
+        }
+        _buffer[_used++] = value;
+        return 1;
+    }
+    using Print::write;
+
+    void flush() override {
+        if (_used == 0) return;
+        if (_file.write(_buffer, _used) != _used) {
+            failed = true;
+        }
+        crc     = crc32(_buffer, _used, crc);
+        length += _used;
+        _used   = 0;
+    }
+
+    uint32_t length;
+    uint32_t crc;
+    bool     failed;
+
+private:
+    File&   _file;
+    uint8_t _buffer[64];
+    size_t  _used;
+};
+
+// hash of the filter keys independent of their order (0: no filter)
+static uint32_t _hashFilter(const JsonDocument * pFilter) {
+    if (pFilter == nullptr) {
+        return 0;
+    }
+    uint32_t hash = 0;
+    for (JsonPairConst kv : pFilter->as<JsonObjectConst>()) {
+        hash += stringHash(kv.key().c_str());
+    }
+    return (hash == 0) ? 1 : hash;
+}
+
+Config::Config(String filename, String objectName) : Dump(objectName), _filename(filename) {
+    recursive_mutex_init(&_mutex);
+}
 
 void Config::begin() {
+    FsLock fsLock;
     if (!LittleFS.begin()) {
         LOG("Failed to mount LittleFS");
     }
 }
 
-bool Config::load() {
+bool Config::load(const JsonDocument * pFilter) {
+    CoreLock lock(&_mutex);
+    FsLock fsLock;
+    uint32_t start = micros();
+    _pLoadFilter = pFilter;
+    // the export keeps the keys of other projects in the JSON file: all keys except the ones of the filter
+    _foreignFilter.clear();
+    if (pFilter != nullptr) {
+        _foreignFilter["*"] = true;
+        for (JsonPairConst kv : pFilter->as<JsonObjectConst>()) {
+            _foreignFilter[kv.key()] = false;
+        }
+    }
+    _filterHash = _hashFilter(pFilter);
+    bool result;
+    if (_journalFile.length() > 0) {
+        result = _journalLoad();
+    } else {
+        result = _loadJson();
+    }
+    _pLoadFilter = nullptr;
+    _loadTime_us = micros() - start;
+    LOG("Config loaded from " + String(_loadSource) + " in " + String(_loadTime_us) + " us");
+    return result;
+}
+
+bool Config::_loadJson() {
+    // snapshot first, JSON only if it was changed since the snapshot was written (e.g. by the PC tools)
+    uint32_t jsonSize = 0;
+    uint32_t jsonCrc  = 0;
+    bool haveJson = (_snapshotFile.length() > 0) && (_journalFile.length() == 0) && _jsonFingerprint(jsonSize, jsonCrc);
+    if (haveJson && _loadSnapshot(jsonSize, jsonCrc)) {
+        _loadSource = "snapshot";
+        _rebuildCache();
+        _dirtyKeys.clear();
+        return true;
+    }
+
+    _loadSource = "json";
     File file = LittleFS.open(_filename, "r");
     if (!file) {
         LOG("Failed to open config file for reading");
         return false;
     }
 
-    DeserializationError error = deserializeJson(_configData, file);
+    DeserializationError error;
+    if (_pLoadFilter != nullptr) {
+        error = deserializeJson(_configData, file, DeserializationOption::Filter(*_pLoadFilter));
+    } else {
+        error = deserializeJson(_configData, file);
+    }
     file.close();
+    _rebuildCache();
+    _dirtyKeys.clear();
 
     if (error) {
         LOG("Failed to parse JSON content");
         return false;
     }
 
+    if (haveJson) {
+        _writeSnapshot(jsonSize, jsonCrc);
+    }
     return true;
 }
 
 bool Config::save() {
+    CoreLock lock(&_mutex);
+    FsLock fsLock;
+    if (_journalFile.length() > 0) {
+        return _journalSave();
+    }
+    if (!exportJson()) {
+        return false;
+    }
+    _dirtyKeys.clear();
+    return true;
+}
+
+// writes the configuration as JSON file .. the format of the PC tools, also in journal mode
+bool Config::exportJson() {
+    CoreLock lock(&_mutex);
+    FsLock fsLock;
+    if (_journalFile.length() > 0) {
+        // the journal header keeps the fingerprint of the export .. both are written together
+        return _journalCompact();
+    }
+    uint32_t jsonSize, jsonCrc;
+    if (!_writeJson(jsonSize, jsonCrc)) {
+        return false;
+    }
+    _writeSnapshot(jsonSize, jsonCrc);
+    return true;
+}
+
+// JSON file of the configuration, jsonSize/jsonCrc: fingerprint of the written file
+// filtered load: _configData holds only the keys of the filter, the JSON file also the keys of other projects
+// .. these are read again (without the keys of the filter) and written back, followed by the keys of _configData
+bool Config::_writeJson(uint32_t& jsonSize, uint32_t& jsonCrc) {
+    JsonDocument merged;
+    if (!_foreignFilter.isNull()) {
+        if (!_loadForeignKeys(merged)) {
+            return false;
+        }
+        for (JsonPairConst kv : _configData.as<JsonObjectConst>()) {
+            merged[kv.key()] = kv.value();
+        }
+    }
+
     File file = LittleFS.open(_filename, "w");
+    fsStatCache.invalidate();       // new size (or new file)
     if (!file) {
         LOG("Failed to open config file for writing");
         return false;
     }
 
-    if (serializeJson(_configData, file) == 0) {
+    // straight into the file, no copy of the JSON text in RAM
+    JsonFileWriter writer(file);
+    size_t length = serializeJson(_foreignFilter.isNull() ? _configData : merged, writer);
+    writer.flush();
+    file.close();
+    if ((length == 0) || writer.failed) {
         LOG("Failed to write JSON content");
-        file.close();
         return false;
     }
+    jsonSize = writer.length;
+    jsonCrc  = writer.crc;
+    return true;
+}
 
+// keys of the JSON file that are not part of the load filter (other projects)
+bool Config::_loadForeignKeys(JsonDocument& doc) {
+    File file = LittleFS.open(_filename, "r");
+    if (!file) {
+        return true;                // no file yet .. nothing to keep
+    }
+    DeserializationError error = deserializeJson(doc, file, DeserializationOption::Filter(_foreignFilter));
     file.close();
+    if (error && (error != DeserializationError::EmptyInput)) {
+        // never drop the keys of other projects
+        LOG("Config export: JSON file not readable, not written (" + String(error.c_str()) + ")");
+        return false;
+    }
     return true;
 }
 
+bool Config::saveIfDirty() {
+    CoreLock lock(&_mutex);
+    if (_dirtyKeys.empty()) {
+        return true;
+    }
+    return save();
+}
+
+// debounced autosave .. one flash write per burst of changes
+void Config::loop(uint32_t now_ms) {
+    CoreLock lock(&_mutex);
+    if ((_autosaveDelay_ms == CONFIG_AUTOSAVE_OFF) || _dirtyKeys.empty()) {
+        return;
+    }
+    if (now_ms - _lastChange_ms < _autosaveDelay_ms) {
+        return;
+    }
+    LOG("Config autosave: " + String(_dirtyKeys.size()) + " changed keys");
+    if (!save()) {
+        // retry after the next delay, not in every loop
+        _lastChange_ms = now_ms;
+    }
+}
+
 String Config::dump(uint32_t now_ms, uint32_t userID) const {
+    CoreLock lock(&_mutex);
     String output = "Config Dump at " + String(now_ms) + " ms:\n";
 
     // Füge den Dateinamen hinzu
     output += "  Filename: " + _filename + "\n";
+    output += "  Unsaved keys: " + String(_dirtyKeys.size()) + "\n";
+    if (_journalFile.length() > 0) {
+        output += "  Journal: " + _journalFile + "\n";
+    }
+    if (_snapshotFile.length() > 0) {
+        output += "  Snapshot: " + _snapshotFile + "\n";
+    }
+    output += "  Loaded from " + String(_loadSource) + " in " + String(_loadTime_us) + " us\n";
 
     // Füge die Konfigurationsdaten als JSON-String hinzu
     String jsonString;
@@ -62,6 +267,7 @@ String Config::dump(uint32_t now_ms, uint32_t userID) const {
 
 // Getter for string values with default
 bool Config::getStringOrDefault(const String& key, const String& defaultValue, String& value) {
+    CoreLock lock(&_mutex);
     if (_configData[key].is<String>()) {
         value = _configData[key].as<String>();
         return true;
@@ -76,6 +282,7 @@ bool Config::getStringOrDefault(const String& key, const String& defaultValue, S
 
 // Getter for boolean values with default
 bool Config::getBoolOrDefault(const String& key, bool defaultValue, bool& value) {
+    CoreLock lock(&_mutex);
         // If the value is a boolean, return it directly
     if (_configData[key].is<bool>()) {
         value = _configData[key].as<bool>();
@@ -125,6 +332,7 @@ bool Config::getBoolOrDefault(const String& key, bool defaultValue, bool& value)
 
 // Getter for integer values with default
 bool Config::getIntOrDefault(const String& key, int defaultValue, int& value) {
+    CoreLock lock(&_mutex);
     // If the value is an integer, return it directly
     if (_configData[key].is<int>()) {
         value = _configData[key].as<int>();
@@ -150,6 +358,7 @@ bool Config::getIntOrDefault(const String& key, int defaultValue, int& value) {
 
 // Getter for hexadecimal values with default
 bool Config::getHexOrDefault(const String& key, int defaultValue, int& value) {
+    CoreLock lock(&_mutex);
     String temp;
     // If the value is a string (const char*), try to convert it to int
     if (_configData[key].is<const char*>()) {
@@ -171,30 +380,86 @@ bool Config::getHexOrDefault(const String& key, int defaultValue, int& value) {
     return false;
 }
 
+// Getters by ID: cached value, the key based getter only for a missing key or a value of other type (sets the default)
+bool Config::getBoolOrDefault(uint32_t id, bool defaultValue, bool& value) {
+    CoreLock lock(&_mutex);
+    const ConfigCacheEntry * pEntry = _cached(id, CONFIG_CACHE_BOOL);
+    if (pEntry != nullptr) {
+        value = pEntry->boolValue;
+        return true;
+    }
+    return getBoolOrDefault(getKeyFromID(id), defaultValue, value);
+}
+
+bool Config::getIntOrDefault(uint32_t id, int defaultValue, int& value) {
+    CoreLock lock(&_mutex);
+    const ConfigCacheEntry * pEntry = _cached(id, CONFIG_CACHE_INT);
+    if (pEntry != nullptr) {
+        value = pEntry->intValue;
+        return true;
+    }
+    return getIntOrDefault(getKeyFromID(id), defaultValue, value);
+}
+
+bool Config::getHexOrDefault(uint32_t id, int defaultValue, int& value) {
+    CoreLock lock(&_mutex);
+    const ConfigCacheEntry * pEntry = _cached(id, CONFIG_CACHE_HEX);
+    if (pEntry != nullptr) {
+        value = pEntry->hexValue;
+        return true;
+    }
+    return getHexOrDefault(getKeyFromID(id), defaultValue, value);
+}
+
 // Setter for string values
 void Config::setString(const String& key, const String& value) {
+    CoreLock lock(&_mutex);
+    if (_configData[key] == value.c_str()) {
+        return;
+    }
     _configData[key] = value;
+    _markDirty(key.c_str());
+    _updateCache(key.c_str());
 }
 
 // Setter for boolean values
 void Config::setBool(const String& key, bool value) {
+    CoreLock lock(&_mutex);
+    if (_configData[key] == value) {
+        return;
+    }
     _configData[key] = value;
+    _markDirty(key.c_str());
+    _updateCache(key.c_str());
 }
 
 // Setter for integer values
 void Config::setInt(const String& key, int value) {
+    CoreLock lock(&_mutex);
+    if (_configData[key] == value) {
+        return;
+    }
     _configData[key] = value;
+    _markDirty(key.c_str());
+    _updateCache(key.c_str());
 }
 
 // Setter for hexadecimal values
 void Config::setHex(const String& key, int value) {
+    CoreLock lock(&_mutex);
     char hexString[10];
     snprintf(hexString, sizeof(hexString), "0x%X", value);
+    if (_configData[key] == (const char *)hexString) {
+        return;
+    }
     _configData[key] = hexString;
+    _markDirty(key.c_str());
+    _updateCache(key.c_str());
 }
 
 // Converts the configuration to a JSON string
 String Config::toString() {
+    CoreLock lock(&_mutex);
     String jsonString;
     serializeJson(_configData, jsonString);
     return jsonString;
@@ -202,16 +467,29 @@ String Config::toString() {
 
 // Rebuilds the configuration from a JSON string
 bool Config::fromString(const String& jsonString) {
-    DeserializationError error = deserializeJson(_configData, jsonString);
+    CoreLock lock(&_mutex);
+    // parse into a separate document .. a broken string leaves the configuration untouched
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, jsonString);
     if (error) {
         LOG("Failed to parse JSON string");
         return false;
     }
+
+    _configData = std::move(doc);
+    _rebuildCache();
+    // new document .. all keys differ from the file, removed keys need a compaction of the journal
+    _dirtyKeys.clear();
+    _journalRewrite = true;
+    for (JsonPair kv : _configData.as<JsonObject>()) {
+        _markDirty(kv.key().c_str());
+    }
     return true;
 }
 
 // Merges a JSON string into the current configuration
 bool Config::mergeFromString(const String& jsonString) {
+    CoreLock lock(&_mutex);
     JsonDocument doc;
     DeserializationError error = deserializeJson(doc, jsonString);
     if (error) {
@@ -220,13 +498,25 @@ bool Config::mergeFromString(const String& jsonString) {
     }
 
     for (JsonPair kv : doc.as<JsonObject>()) {
+        if (_configData[kv.key()] == kv.value()) {
+            continue;
+        }
         _configData[kv.key()] = kv.value();
+        _updateCache(kv.key().c_str());
+        _markDirty(kv.key().c_str());
     }
 
     return true;
 }
 
 
+void Config::buildStringIdFilter(JsonDocument& filter) {
+    filter.clear();
+    StringID::getInstance().forEach([&filter](uint32_t id, const char * name) {
+        filter[name] = true;
+    });
+}
+
 String Config::getKeyFromID(uint32_t id) const {
     const char* key = StringID::getInstance().getString(id);
     if (key == nullptr) {
@@ -235,3 +525,468 @@ String Config::getKeyFromID(uint32_t id) const {
     }
     return String(key);
 }
+
+// all keys of the document
+void Config::_rebuildCache() {
+    _cache.clear();
+    for (JsonPair kv : _configData.as<JsonObject>()) {
+        _updateCache(kv.key().c_str());
+    }
+}
+
+// same interpretation of the JSON value as the key based getters (numbers are often stored as strings)
+void Config::_updateCache(const char * key) {
+    // only keys with a StringID can be read by ID
+    uint32_t id = stringHash(key);
+    const char * name = StringID::getInstance().getString(id);
+    if ((name == nullptr) || (strcmp(name, key) != 0)) {
+        return;
+    }
+
+    ConfigCacheEntry entry = {0, 0, false, 0};
+    JsonVariantConst value = _configData[key];
+    if (value.is<bool>()) {
+        entry.boolValue = value.as<bool>();
+        entry.valid |= CONFIG_CACHE_BOOL;
+    } else if (value.is<int>()) {
+        entry.intValue  = value.as<int>();
+        entry.boolValue = (entry.intValue != 0);
+        entry.valid |= CONFIG_CACHE_INT | CONFIG_CACHE_BOOL;
+    } else if (value.is<const char*>()) {
+        const char * str = value.as<const char*>();
+        entry.intValue = atoi(str);
+        entry.hexValue = convertStrToInt(str);
+        entry.valid |= CONFIG_CACHE_INT | CONFIG_CACHE_HEX;
+
+        String val = str;
+        val.toLowerCase();
+        if (val == "true"  || val == "1" || val == "yes" || val == "on" ) {
+            entry.boolValue = true;
+            entry.valid |= CONFIG_CACHE_BOOL;
+        } else if (val == "false" || val == "0" || val == "no"  || val == "off") {
+            entry.boolValue = false;
+            entry.valid |= CONFIG_CACHE_BOOL;
+        }
+    }
+
+    if (entry.valid == 0) {
+        _cache.erase(id);
+    } else {
+        _cache[id] = entry;
+    }
+}
+
+const ConfigCacheEntry * Config::_cached(uint32_t id, uint8_t type) const {
+    auto it = _cache.find(id);
+    if ((it == _cache.end()) || ((it->second.valid & type) == 0)) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+void Config::_markDirty(const char * key) {
+    _dirtyKeys[stringHash(key)] = key;
+    _lastChange_ms = millis();
+}
+
+/*****************************************************************
+ *
+ *    journal backend
+ *
+ *    "CJN3" + filter hash u32 + JSON size u32 + JSON crc32 u32 (fingerprint of the JSON export written with the journal)
+ *    + records: type u8, key length u8, value length u16, key, value, crc32 u32 (over all before)
+ *    the last record of a key wins, a broken record (power loss while appending) ends the journal
+ *    a JSON file that does not match the fingerprint was changed by the PC tools and is imported
+ *
+ ******************************************************************
+ */
+void Config::useJournal(const String& journalFile) {
+    _journalFile = journalFile;
+}
+
+bool Config::_journalLoad() {
+    String tmpName = _journalFile + ".tmp";
+    if (!LittleFS.exists(_journalFile) && LittleFS.exists(tmpName)) {
+        // power loss during compaction, after the remove of the old journal
+        LittleFS.rename(tmpName, _journalFile);
+        fsStatCache.invalidate();
+    }
+    File file = LittleFS.open(_journalFile, "r");
+    uint32_t filterHash, exportSize, exportCrc;
+    if (!file || !_readJournalHeader(file, filterHash, exportSize, exportCrc)) {
+        // first start with journal (or a journal of an older format): migrate the JSON file
+        file.close();
+        LOG("Config journal not found (or older format), migrate " + _filename);
+        if (!_loadJson()) {
+            return false;
+        }
+        return _journalCompact();
+    }
+    if (_jsonChanged(exportSize, exportCrc)) {
+        // JSON file replaced since the last export (PC tools) .. it is newer than the journal
+        LOG("Config JSON changed, import " + _filename);
+        if (_loadJson()) {
+            file.close();
+            _journalCompact();
+            return true;
+        }
+    }
+    bool otherKeys = (filterHash != _filterHash);
+    if (otherKeys) {
+        // journal of another key set (firmware update): keys new in the filter come from the JSON export,
+        // the journal is replayed on top (it is newer than the export)
+        LOG("Config journal of another key set, replay on top of " + _filename);
+        if (!_loadJson()) {
+            _configData.clear();
+        }
+    } else {
+        _configData.clear();
+    }
+    _loadSource = "journal";
+    _dirtyKeys.clear();
+    _journalRewrite = false;
+
+    size_t records = 0;
+    size_t validSize = CONFIG_JOURNAL_FILE_HEADER_SIZE;
+    uint8_t header[CONFIG_JOURNAL_HEADER_SIZE];
+    char key[256];
+    std::vector<uint8_t> value;
+    while (file.read(header, CONFIG_JOURNAL_HEADER_SIZE) == CONFIG_JOURNAL_HEADER_SIZE) {
+        uint8_t  type        = header[0];
+        uint8_t  keyLength   = header[1];
+        uint16_t valueLength = header[2] | (header[3] << 8);
+        // torn tail: the lengths are not covered by a crc yet .. no allocation beyond the end of the file
+        if ((size_t)keyLength + valueLength + 4 > file.size() - file.position()) {
+            break;
+        }
+        value.resize(valueLength + 1);
+        uint8_t crcBytes[4];
+        if ((file.read((uint8_t*)key, keyLength) != keyLength) ||
+            (file.read(value.data(), valueLength) != valueLength) ||
+            (file.read(crcBytes, 4) != 4)) {
+            break;
+        }
+        uint32_t crc = crc32(header, CONFIG_JOURNAL_HEADER_SIZE);
+        crc = crc32((const uint8_t*)key, keyLength, crc);
+        crc = crc32(value.data(), valueLength, crc);
+        if (crc != (crcBytes[0] | (crcBytes[1] << 8) | (crcBytes[2] << 16) | ((uint32_t)crcBytes[3] << 24))) {
+            break;
+        }
+        key[keyLength] = 0;
+        value[valueLength] = 0;
+        _journalApply(key, type, value.data(), valueLength);
+        validSize = file.position();
+        records++;
+    }
+    bool complete = (file.position() == file.size()) && (validSize == file.size());
+    file.close();
+
+    if (!complete) {
+        // drop the broken tail, later appends must follow the last valid record
+        LOG("Config journal: broken record at " + String(validSize) + ", truncated");
+        file = LittleFS.open(_journalFile, "r+");
+        if (file) {
+            file.truncate(validSize);
+            file.close();
+            fsStatCache.invalidate();
+        }
+    }
+    _rebuildCache();
+    LOG("Config journal: " + String(records) + " records replayed");
+    if (otherKeys) {
+        // new header with the hash of this key set
+        _journalCompact();
+    }
+    return true;
+}
+
+void Config::_journalApply(const char * key, uint8_t type, const uint8_t * pValue, size_t length) {
+    if ((_pLoadFilter != nullptr) && !(*_pLoadFilter)[key].as<bool>()) {
+        return;
+    }
+    switch (type) {
+        case CONFIG_JOURNAL_INT:
+            if (length == 4) {
+                _configData[key] = (int32_t)(pValue[0] | (pValue[1] << 8) | (pValue[2] << 16) | ((uint32_t)pValue[3] << 24));
+            }
+            break;
+        case CONFIG_JOURNAL_BOOL:
+            if (length == 1) {
+                _configData[key] = (pValue[0] != 0);
+            }
+            break;
+        case CONFIG_JOURNAL_STRING:
+            _configData[key] = (const char *)pValue;
+            break;
+        case CONFIG_JOURNAL_JSON: {
+            JsonDocument doc;
+            if (!deserializeJson(doc, (const char *)pValue, length)) {
+                _configData[key] = doc;
+            }
+            break;
+        }
+        case CONFIG_JOURNAL_REMOVE:
+            _configData.remove(key);
+            break;
+        default:
+            LOG("Config journal: unknown record type " + String(type));
+            break;
+    }
+}
+
+bool Config::_journalAppend(File& file, const char * key, JsonVariantConst value) {
+    size_t keyLength = strlen(key);
+    if (keyLength > 255) {
+        LOG("Config journal: key too long " + String(key));
+        return false;
+    }
+
+    uint8_t  type;
+    uint8_t  number[4];
+    String   text;
+    const uint8_t * pValue;
+    size_t   valueLength;
+    if (value.isNull()) {
+        type = CONFIG_JOURNAL_REMOVE;
+        pValue = number;
+        valueLength = 0;
+    } else if (value.is<bool>()) {
+        type = CONFIG_JOURNAL_BOOL;
+        number[0] = value.as<bool>() ? 1 : 0;
+        pValue = number;
+        valueLength = 1;
+    } else if (value.is<int32_t>()) {
+        type = CONFIG_JOURNAL_INT;
+        uint32_t v = (uint32_t)value.as<int32_t>();
+        number[0] = v & 0xFF;   number[1] = (v >> 8) & 0xFF;
+        number[2] = (v >> 16) & 0xFF;   number[3] = (v >> 24) & 0xFF;
+        pValue = number;
+        valueLength = 4;
+    } else if (value.is<const char*>()) {
+        type = CONFIG_JOURNAL_STRING;
+        pValue = (const uint8_t*)value.as<const char*>();
+        valueLength = strlen((const char*)pValue);
+    } else {
+        // float, array, object ..
+        type = CONFIG_JOURNAL_JSON;
+        serializeJson(value, text);
+        pValue = (const uint8_t*)text.c_str();
+        valueLength = text.length();
+    }
+    if (valueLength > 0xFFFF) {
+        LOG("Config journal: value too long " + String(key));
+        return false;
+    }
+
+    uint8_t header[CONFIG_JOURNAL_HEADER_SIZE] = { type, (uint8_t)keyLength, (uint8_t)(valueLength & 0xFF), (uint8_t)(valueLength >> 8) };
+    uint32_t crc = crc32(header, CONFIG_JOURNAL_HEADER_SIZE);
+    crc = crc32((const uint8_t*)key, keyLength, crc);
+    crc = crc32(pValue, valueLength, crc);
+    uint8_t crcBytes[4] = { (uint8_t)(crc & 0xFF), (uint8_t)((crc >> 8) & 0xFF), (uint8_t)((crc >> 16) & 0xFF), (uint8_t)(crc >> 24) };
+
+    return (file.write(header, CONFIG_JOURNAL_HEADER_SIZE) == CONFIG_JOURNAL_HEADER_SIZE) &&
+           (file.write((const uint8_t*)key, keyLength) == keyLength) &&
+           (file.write(pValue, valueLength) == valueLength) &&
+           (file.write(crcBytes, 4) == 4);
+}
+
+// one small append per changed key, compaction only if the journal has grown too much
+bool Config::_journalSave() {
+    if (_journalRewrite || !LittleFS.exists(_journalFile)) {
+        return _journalCompact();
+    }
+
+    File file = LittleFS.open(_journalFile, "a");
+    fsStatCache.invalidate();
+    if (!file) {
+        LOG("Failed to open config journal for appending");
+        return false;
+    }
+    for (auto& entry : _dirtyKeys) {
+        if (!_journalAppend(file, entry.second.c_str(), _configData[entry.second])) {
+            LOG("Failed to append to config journal");
+            file.close();
+            return false;
+        }
+    }
+    size_t size = file.size();
+    file.close();
+    _dirtyKeys.clear();
+
+    if (size > CONFIG_JOURNAL_MAX_SIZE) {
+        return _journalCompact();
+    }
+    return true;
+}
+
+// JSON export for the PC tools, then one record per key into a new journal with the fingerprint of the export
+bool Config::_journalCompact() {
+    uint32_t jsonSize, jsonCrc;
+    if (!_writeJson(jsonSize, jsonCrc)) {
+        return false;
+    }
+
+    String tmpName = _journalFile + ".tmp";
+    File file = LittleFS.open(tmpName, "w");
+    fsStatCache.invalidate();
+    if (!file) {
+        LOG("Failed to open config journal for compaction");
+        return false;
+    }
+    uint8_t header[CONFIG_JOURNAL_FILE_HEADER_SIZE];
+    memcpy(header, CONFIG_JOURNAL_MAGIC, CONFIG_JOURNAL_MAGIC_SIZE);
+    _putUint32(&header[4],  _filterHash);
+    _putUint32(&header[8],  jsonSize);
+    _putUint32(&header[12], jsonCrc);
+    bool ok = (file.write(header, CONFIG_JOURNAL_FILE_HEADER_SIZE) == CONFIG_JOURNAL_FILE_HEADER_SIZE);
+    for (JsonPair kv : _configData.as<JsonObject>()) {
+        if (!ok) {
+            break;
+        }
+        ok = _journalAppend(file, kv.key().c_str(), kv.value());
+    }
+    file.close();
+    if (!ok) {
+        LOG("Failed to write compacted config journal");
+        LittleFS.remove(tmpName);
+        return false;
+    }
+
+    if (LittleFS.exists(_journalFile) && !LittleFS.remove(_journalFile)) {
+        LOG("Failed to remove old config journal");
+        return false;
+    }
+    if (!LittleFS.rename(tmpName, _journalFile)) {
+        LOG("Failed to rename compacted config journal");
+        return false;
+    }
+    _dirtyKeys.clear();
+    _journalRewrite = false;
+    LOG("Config journal compacted");
+    return true;
+}
+
+bool Config::_readJournalHeader(File& file, uint32_t& filterHash, uint32_t& jsonSize, uint32_t& jsonCrc) {
+    uint8_t header[CONFIG_JOURNAL_FILE_HEADER_SIZE];
+    if ((file.read(header, CONFIG_JOURNAL_FILE_HEADER_SIZE) != CONFIG_JOURNAL_FILE_HEADER_SIZE) ||
+        (memcmp(header, CONFIG_JOURNAL_MAGIC, CONFIG_JOURNAL_MAGIC_SIZE) != 0)) {
+        return false;
+    }
+    filterHash = _getUint32(&header[4]);
+    jsonSize   = _getUint32(&header[8]);
+    jsonCrc    = _getUint32(&header[12]);
+    return true;
+}
+
+/*****************************************************************
+ *
+ *    binary snapshot
+ *
+ *    "CMP2" + JSON size u32 + JSON crc32 u32 + filter hash u32 + MessagePack of the configuration
+ *    valid as long as the JSON file has the same size and CRC (fingerprint) as at the time of writing
+ *    and the load filter has the same keys
+ *
+ ******************************************************************
+ */
+void Config::useSnapshot(const String& snapshotFile) {
+    _snapshotFile = snapshotFile;
+}
+
+// reading and a CRC of the JSON file costs much less than deserializeJson
+bool Config::_jsonFingerprint(uint32_t& size, uint32_t& crc) {
+    File file = LittleFS.open(_filename, "r");
+    if (!file) {
+        return false;
+    }
+    uint8_t buffer[CONFIG_SNAPSHOT_READ_SIZE];
+    size = 0;
+    crc  = 0;
+    int count;
+    while ((count = file.read(buffer, sizeof(buffer))) > 0) {
+        crc = crc32(buffer, count, crc);
+        size += count;
+    }
+    file.close();
+    return true;
+}
+
+// JSON file differs from the fingerprint of the last export .. size first, the CRC only if the size is equal
+bool Config::_jsonChanged(uint32_t exportSize, uint32_t exportCrc) {
+    File file = LittleFS.open(_filename, "r");
+    if (!file) {
+        return false;
+    }
+    size_t size = file.size();
+    file.close();
+    if (size != exportSize) {
+        return true;
+    }
+    uint32_t jsonSize, jsonCrc;
+    return _jsonFingerprint(jsonSize, jsonCrc) && (jsonCrc != exportCrc);
+}
+
+bool Config::_readSnapshotHeader(File& file, uint32_t& jsonSize, uint32_t& jsonCrc, uint32_t& filterHash) {
+    uint8_t header[CONFIG_SNAPSHOT_HEADER_SIZE];
+    if ((file.read(header, CONFIG_SNAPSHOT_HEADER_SIZE) != CONFIG_SNAPSHOT_HEADER_SIZE) ||
+        (memcmp(header, CONFIG_SNAPSHOT_MAGIC, CONFIG_SNAPSHOT_MAGIC_SIZE) != 0)) {
+        return false;
+    }
+    jsonSize   = _getUint32(&header[4]);
+    jsonCrc    = _getUint32(&header[8]);
+    filterHash = _getUint32(&header[12]);
+    return true;
+}
+
+bool Config::_loadSnapshot(uint32_t jsonSize, uint32_t jsonCrc) {
+    if (_snapshotFile.length() == 0) {
+        return false;
+    }
+    File file = LittleFS.open(_snapshotFile, "r");
+    if (!file) {
+        return false;
+    }
+    uint32_t size, crc, filterHash;
+    if (!_readSnapshotHeader(file, size, crc, filterHash) || (size != jsonSize) || (crc != jsonCrc) || (filterHash != _filterHash)) {
+        file.close();
+        LOG("Config snapshot outdated");
+        return false;
+    }
+    DeserializationError error;
+    if (_pLoadFilter != nullptr) {
+        error = deserializeMsgPack(_configData, file, DeserializationOption::Filter(*_pLoadFilter));
+    } else {
+        error = deserializeMsgPack(_configData, file);
+    }
+    file.close();
+    if (error) {
+        LOG("Failed to parse config snapshot");
+        return false;
+    }
+    return true;
+}
+
+bool Config::_writeSnapshot(uint32_t jsonSize, uint32_t jsonCrc) {
+    if (_snapshotFile.length() == 0) {
+        return true;
+    }
+    File file = LittleFS.open(_snapshotFile, "w");
+    fsStatCache.invalidate();
+    if (!file) {
+        LOG("Failed to open config snapshot for writing");
+        return false;
+    }
+    uint8_t header[CONFIG_SNAPSHOT_HEADER_SIZE];
+    memcpy(header, CONFIG_SNAPSHOT_MAGIC, CONFIG_SNAPSHOT_MAGIC_SIZE);
+    _putUint32(&header[4],  jsonSize);
+    _putUint32(&header[8],  jsonCrc);
+    _putUint32(&header[12], _filterHash);
+    bool ok = (file.write(header, CONFIG_SNAPSHOT_HEADER_SIZE) == CONFIG_SNAPSHOT_HEADER_SIZE) &&
+              (serializeMsgPack(_configData, file) > 0);
+    file.close();
+    if (!ok) {
+        // a broken snapshot would only be rejected at the next boot
+        LOG("Failed to write config snapshot");
+        LittleFS.remove(_snapshotFile);
+    }
+    return ok;
+}
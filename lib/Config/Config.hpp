@@ -31,6 +31,38 @@
  * integers, and hexadecimal values. The class also allows setting default values for missing keys
  * and automatically adds them to the configuration file.
  * 
+ * Keys registered as StringID are additionally held in a typed cache (int/bool/hex), so the
+ * getters by ID (e.g. getInt(CFG_LED_COUNT)) neither build a key String nor search and parse the JSON document.
+ * 
+ * Setters only mark a key dirty if its value really changes. saveIfDirty() writes the file only
+ * if there are unsaved changes; with setAutosave(delay) loop(now) does this once per burst of
+ * changes, delay ms after the last one.
+ * 
+ * With useJournal(file) the configuration is stored in an append-only binary journal instead:
+ * a save appends one small record per changed key, load replays it. If the journal grows beyond
+ * CONFIG_JOURNAL_MAX_SIZE it is compacted (one record per key) and the JSON file is exported again
+ * for the PC tools (or explicit by exportJson()). Without a journal the JSON file is migrated at load.
+ * The journal header keeps size and CRC32 of the last export, a JSON file changed by the PC tools
+ * is imported at load. load() compares the size of the JSON file first, the CRC32 (one read of the
+ * file, no parse) is only built if the size is unchanged .. so a boot with journal still reads the
+ * JSON file once.
+ * 
+ * With useSnapshot(file) (JSON mode only) every JSON export also writes a MessagePack snapshot together
+ * with the size and CRC32 of the JSON file. load() reads the snapshot instead of parsing the JSON, as
+ * long as the JSON file is unchanged. In journal mode load() replays the journal, a snapshot is not used.
+ * The load time is reported by getLoadTime_us() / getLoadSource().
+ * 
+ * All public functions hold a cross-core lock (CoreLock): getters may run on core1 (dumps) while
+ * loop() saves on core0. Load and save also hold the file system lock (FsLock).
+ * 
+ * load(&filter) only keeps the keys of the filter (JSON, snapshot and journal), e.g. a filter of all
+ * registered StringIDs built by buildStringIdFilter(). Config files shared by several projects then
+ * cost only the heap of the keys this firmware uses. The JSON export reads only the keys of other
+ * projects from the old file (filter without the own keys) and writes them back unchanged, followed
+ * by the keys of this firmware. A JSON file that can not be parsed is not overwritten.
+ * Journal and snapshot hold a hash of the filter keys: after a firmware update with other keys the
+ * snapshot is not used and the journal is replayed on top of the JSON file (new keys come from there).
+ * 
  * Example usage:
  * 
  * @code
@@ -68,6 +100,10 @@
 #include <LittleFS.h>
 #include <Debug.hpp>
 #include <StringId.h>
+#include <helper.h>
+#include <CoreLock.hpp>
+#include <unordered_map>
+#include <vector>
 
 #define CONFIG_DEFAULT_FILE "/config.json" // Default configuration file name
 
@@ -77,6 +113,38 @@
 #define CONFIG_DEFAULT_UINT_VALUE       0       // Default integer value for missing keys    
 #define CONFIG_DEFAULT_HEX_VALUE        0       // Default hexadecimal value for missing keys
 #define CONFIG_DEFAULT_KEY              "default" // Default key for missing values
+#define CONFIG_AUTOSAVE_OFF             0       // setAutosave: no autosave (default)
+#define CONFIG_AUTOSAVE_DELAY_MS        2000    // suggested autosave delay after the last change
+
+// append-only journal backend (see Config::useJournal)
+#define CONFIG_JOURNAL_MAGIC            "CJN3"
+#define CONFIG_JOURNAL_MAGIC_SIZE       4
+#define CONFIG_JOURNAL_FILE_HEADER_SIZE 16      // magic, filter hash u32, JSON size u32, JSON crc32 u32 (fingerprint of the export)
+#define CONFIG_JOURNAL_HEADER_SIZE      4       // record: type u8, key length u8, value length u16
+#define CONFIG_JOURNAL_MAX_SIZE         4096    // compaction if the journal grows beyond
+#define CONFIG_JOURNAL_INT              1       // int32 little endian
+#define CONFIG_JOURNAL_BOOL             2       // u8
+#define CONFIG_JOURNAL_STRING           3       // chars without 0
+#define CONFIG_JOURNAL_JSON             4       // other values (float, array, object) as serialized JSON
+#define CONFIG_JOURNAL_REMOVE           5       // key removed, no value
+
+// binary snapshot (see Config::useSnapshot)
+#define CONFIG_SNAPSHOT_MAGIC           "CMP2"
+#define CONFIG_SNAPSHOT_MAGIC_SIZE      4
+#define CONFIG_SNAPSHOT_HEADER_SIZE     16      // magic, JSON size u32, JSON crc32 u32, filter hash u32
+#define CONFIG_SNAPSHOT_READ_SIZE       256     // buffer for the JSON fingerprint
+
+// typed value cache (see Config::_updateCache): which interpretations of a value are valid
+#define CONFIG_CACHE_INT                0x01
+#define CONFIG_CACHE_BOOL               0x02
+#define CONFIG_CACHE_HEX                0x04
+
+struct ConfigCacheEntry {
+    int32_t intValue;       // getInt
+    int32_t hexValue;       // getHex
+    bool    boolValue;      // getBool
+    uint8_t valid;          // CONFIG_CACHE_xxx
+};
 
 class Config : public Dump{
     public:
@@ -89,15 +157,52 @@ class Config : public Dump{
 
         /**
          * @brief Loads the configuration from the JSON file.
+         * @param pFilter Optional ArduinoJson filter ({"key": true, ..}), other keys are skipped while parsing.
          * @return True if the configuration was loaded successfully, false otherwise.
          */
-        bool load();
+        bool load(const JsonDocument * pFilter = nullptr);
+
+        /**
+         * @brief Builds a load filter of all registered StringIDs, more keys can be added by filter[key] = true.
+         */
+        static void buildStringIdFilter(JsonDocument& filter);
 
         /**
          * @brief Saves the current configuration to the JSON file.
          * @return True if the configuration was saved successfully, false otherwise.
          */
         bool save();
+
+        /**
+         * @brief Saves the configuration only if a key was changed since the last load/save.
+         * @return True if nothing was to do or the configuration was saved successfully.
+         */
+        bool saveIfDirty();
+
+        /**
+         * @brief Store the configuration in an append-only journal, call before load().
+         * @param journalFile The name of the journal file, the JSON file remains as export.
+         */
+        void useJournal(const String& journalFile);
+        bool exportJson();
+
+        /**
+         * @brief Keep a binary (MessagePack) snapshot for a fast load, call before load().
+         * @param snapshotFile The name of the snapshot file, the JSON file remains the interchange format.
+         */
+        void useSnapshot(const String& snapshotFile);
+        inline uint32_t getLoadTime_us() const                  { return _loadTime_us; }
+        inline const char * getLoadSource() const               { return _loadSource; }
+        inline bool isDirty() const                             { return !_dirtyKeys.empty(); }
+        inline bool isDirty(const String& key) const            { return _dirtyKeys.count(stringHash(key.c_str())) > 0; }
+        inline size_t dirtyCount() const                        { return _dirtyKeys.size(); }
+
+        /**
+         * @brief Debounced autosave: loop() saves delay_ms after the last change (CONFIG_AUTOSAVE_OFF disables it).
+         */
+        inline void setAutosave(uint32_t delay_ms)              { _autosaveDelay_ms = delay_ms; }
+        void loop(uint32_t now_ms);
+
         /**
          * @brief Dumps the current configuration state as a JSON string.
          * @param now_ms The current timestamp in milliseconds.
@@ -123,25 +228,25 @@ class Config : public Dump{
         bool getBoolOrDefault(const String& key, bool defaultValue, bool& value);
         inline bool getBool(const String& key)                  { bool value; getBoolOrDefault(key, CONFIG_DEFAULT_BOOL_VALUE, value); return value;}
         inline bool getBool(const String& key, bool& value)     { return getBoolOrDefault(key, CONFIG_DEFAULT_BOOL_VALUE, value);  }
-        inline bool getBool(uint32_t id)                        { return getBool(getKeyFromID(id));} 
-        inline bool getBool(uint32_t id, bool& value)           { return getBool(getKeyFromID(id), value); }
-        inline bool getBoolOrDefault(uint32_t id, bool defaultValue, bool& value) { return getBoolOrDefault(getKeyFromID(id), defaultValue, value);}
+        inline bool getBool(uint32_t id)                        { bool value; getBoolOrDefault(id, CONFIG_DEFAULT_BOOL_VALUE, value); return value;} 
+        inline bool getBool(uint32_t id, bool& value)           { return getBoolOrDefault(id, CONFIG_DEFAULT_BOOL_VALUE, value); }
+        bool getBoolOrDefault(uint32_t id, bool defaultValue, bool& value);
 
         // Getter for integer values
         bool getIntOrDefault(const String& key, int defaultValue, int& value);
         inline int getInt(const String& key)                    { int value; getIntOrDefault(key, CONFIG_DEFAULT_INT_VALUE, value); return value;}
         inline bool getInt(const String& key, int& value)       { return getIntOrDefault(key, CONFIG_DEFAULT_INT_VALUE, value);   }
-        inline int getInt(uint32_t id)                          { return getInt(getKeyFromID(id)); }
-        inline bool getInt(uint32_t id, int& value)             { return getIntOrDefault(getKeyFromID(id), 0, value); }  
-        inline bool getIntOrDefault(uint32_t id, int defaultValue, int& value) {  return getIntOrDefault(getKeyFromID(id), defaultValue, value);}
+        inline int getInt(uint32_t id)                          { int value; getIntOrDefault(id, CONFIG_DEFAULT_INT_VALUE, value); return value;}
+        inline bool getInt(uint32_t id, int& value)             { return getIntOrDefault(id, 0, value); }  
+        bool getIntOrDefault(uint32_t id, int defaultValue, int& value);
 
         // Getter for hexadecimal values
         bool getHexOrDefault(const String& key, int defaultValue, int& value);
         inline int getHex(const String& key)                    { int value; getHexOrDefault(key, CONFIG_DEFAULT_HEX_VALUE, value); return value;}
         inline bool getHex(const String& key, int& value)       { return getHexOrDefault(key, CONFIG_DEFAULT_HEX_VALUE, value); }
-        inline int getHex(uint32_t id)                          { return getHex(getKeyFromID(id)); }      
-        inline bool getHex(uint32_t id, int& value)             { return getHexOrDefault(getKeyFromID(id), 0, value);}
-        inline bool getHexOrDefault(uint32_t id, int defaultValue, int& value) { return getHexOrDefault(getKeyFromID(id), defaultValue, value);}
+        inline int getHex(uint32_t id)                          { int value; getHexOrDefault(id, CONFIG_DEFAULT_HEX_VALUE, value); return value;}      
+        inline bool getHex(uint32_t id, int& value)             { return getHexOrDefault(id, 0, value);}
+        bool getHexOrDefault(uint32_t id, int defaultValue, int& value);
 
         // Setter for values
         void setString(const String& key, const String& value);
@@ -156,9 +261,50 @@ class Config : public Dump{
     private:
         String _filename;           // The filename of the JSON configuration file
         JsonDocument _configData; // The internal representation of the configuration data
+        mutable recursive_mutex_t _mutex;   // _configData, _cache and _dirtyKeys .. both cores
 
         // Helper function to get the key string from an ID
         String getKeyFromID(uint32_t id) const;
+
+        // typed values of all keys with a StringID .. getters by ID need no key lookup, no JSON search and no parsing
+        // filled at load/fromString, updated by every setter and merge
+        std::unordered_map<uint32_t, ConfigCacheEntry> _cache;
+        void _rebuildCache();
+        void _updateCache(const char * key);
+        const ConfigCacheEntry * _cached(uint32_t id, uint8_t type) const;
+
+        // keys changed since the last load/save (by hash)
+        std::unordered_map<uint32_t, String> _dirtyKeys;
+        volatile uint32_t _lastChange_ms = 0;
+        uint32_t _autosaveDelay_ms = CONFIG_AUTOSAVE_OFF;
+        void _markDirty(const char * key);
+
+        bool _loadJson();
+        bool _writeJson(uint32_t& jsonSize, uint32_t& jsonCrc);
+        bool _loadForeignKeys(JsonDocument& doc);
+        JsonDocument _foreignFilter;        // all keys except the ones of the last load filter (null: no filter), see _writeJson
+        uint32_t _filterHash = 0;           // of the load filter, in journal and snapshot header (0: no filter)
+
+        // journal backend
+        String _journalFile;                // empty: JSON file only
+        bool   _journalRewrite = false;     // keys removed (fromString) .. next save compacts
+        bool _journalLoad();
+        bool _journalSave();
+        bool _journalCompact();
+        bool _readJournalHeader(File& file, uint32_t& filterHash, uint32_t& jsonSize, uint32_t& jsonCrc);
+        void _journalApply(const char * key, uint8_t type, const uint8_t * pValue, size_t length);
+        bool _journalAppend(File& file, const char * key, JsonVariantConst value);
+
+        // snapshot
+        String _snapshotFile;               // empty: no snapshot
+        uint32_t _loadTime_us = 0;
+        const char * _loadSource = "none";  // snapshot, json, journal
+        const JsonDocument * _pLoadFilter = nullptr;    // only during load()
+        bool _jsonFingerprint(uint32_t& size, uint32_t& crc);
+        bool _jsonChanged(uint32_t exportSize, uint32_t exportCrc);
+        bool _readSnapshotHeader(File& file, uint32_t& jsonSize, uint32_t& jsonCrc, uint32_t& filterHash);
+        bool _loadSnapshot(uint32_t jsonSize, uint32_t jsonCrc);
+        bool _writeSnapshot(uint32_t jsonSize, uint32_t jsonCrc);
 };
 
 
@@ -0,0 +1,76 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 MonkeyCodeMen@GitHub
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * provided to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#pragma once
+#include <Arduino.h>
+#include <pico/mutex.h>
+
+/*
+    cross-core lock (RP2040: core0 loop() and core1 loop1() run at the same time)
+
+    holds a recursive mutex of the pico SDK for the lifetime of the object, a function holding the
+    lock can call other functions that take it again (same core). A flag like Mutex.hpp is not
+    enough between two cores.
+
+        CoreLock lock(&_mutex);             // wait until the other core is done
+        CoreLock lock(&_mutex, false);      // only if free .. check isLocked()
+
+    core1 should not wait for core0 (LED timing): it uses wait = false and skips its work if the
+    lock is taken.
+*/
+class CoreLock {
+public:
+    CoreLock(recursive_mutex_t * pMutex, bool wait = true) : _pMutex(pMutex) {
+        if (wait == true) {
+            recursive_mutex_enter_blocking(_pMutex);
+            _locked = true;
+        } else {
+            _locked = recursive_mutex_try_enter(_pMutex, nullptr);
+        }
+    }
+    ~CoreLock() {
+        if (_locked == true) {
+            recursive_mutex_exit(_pMutex);
+        }
+    }
+    CoreLock(const CoreLock&) = delete;
+    CoreLock& operator=(const CoreLock&) = delete;
+
+    bool isLocked() const   { return _locked; }
+
+private:
+    recursive_mutex_t * _pMutex;
+    bool                _locked;
+};
+
+/*
+    LittleFS is not safe for access of both cores at the same time .. every user of the file system
+    (Config load/save, file commands of COM, system info) holds this lock while it works on the flash
+*/
+class FsLock : public CoreLock {
+public:
+    FsLock(bool wait = true);
+};
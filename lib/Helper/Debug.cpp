@@ -27,6 +27,8 @@
 #include "Debug.hpp"
 #include "helper.h"
 #include "LittleFS.h"
+#include <FsStatCache.hpp>
+#include <CoreLock.hpp>
 
 #if defined(ARDUINO_ARDUINO_NANO33BLE) || defined(ARDUINO_ARCH_MBED_RP2040)|| defined(ARDUINO_ARCH_RP2040)
   #include "malloc.h"
@@ -296,6 +298,12 @@ SystemInfo::SystemInfo(const String& name)
     : Dump(name) {}
 
 String SystemInfo::dump(uint32_t now_ms, uint32_t userID) const {
+    StringPrint out;
+    dumpTo(out, now_ms, userID);
+    return out.str;
+}
+
+void SystemInfo::dumpTo(Print& out, uint32_t now_ms, uint32_t userID) const {
     // Get system time
     uint32_t systemTime = now_ms;
 
@@ -314,14 +322,14 @@ String SystemInfo::dump(uint32_t now_ms, uint32_t userID) const {
     uint32_t cpuCycleCount = rp2040.getCycleCount(); // Replace with the correct function for your platform
 
     // Format the output
-    String output = "System Info Dump:\n";
-    output += "  System Time: " + String(systemTime) + " ms\n";
-    output += "  Free Heap: " + String(freeHeap) + " bytes\n";
-    output += "  Used Heap: " + String(usedHeap) + " bytes\n";
-    output += "  Total Heap: " + String(totalHeap) + " bytes\n";
-    output += "  CPU Frequency: " + String(cpuFrequency) + " Hz\n";
-    output += "  CPU ID: " + String(rp2040.getChipID()) + "\n";
-    output += "  CPU Cycle Count: " + String(cpuCycleCount) + "\n";
+    out.print("System Info Dump:\n");
+    out.print("  System Time: " + String(systemTime) + " ms\n");
+    out.print("  Free Heap: " + String(freeHeap) + " bytes\n");
+    out.print("  Used Heap: " + String(usedHeap) + " bytes\n");
+    out.print("  Total Heap: " + String(totalHeap) + " bytes\n");
+    out.print("  CPU Frequency: " + String(cpuFrequency) + " Hz\n");
+    out.print("  CPU ID: " + String(rp2040.getChipID()) + "\n");
+    out.print("  CPU Cycle Count: " + String(cpuCycleCount) + "\n");
     
     // Add RAM usage as a percentage with a bar
     int barLength = 20;  // Length of the bar (20 characters wide)
@@ -334,9 +342,14 @@ String SystemInfo::dump(uint32_t now_ms, uint32_t userID) const {
         ramBar += " ";
     }
 
-    output += "RAM:   [" + ramBar + "]   " + String(ramUsagePercentage, 1) + "% (used " + String(usedHeap) + " bytes from " + String(totalHeap) + " bytes)\n";
+    out.print("RAM:   [" + ramBar + "]   " + String(ramUsagePercentage, 1) + "% (used " + String(usedHeap) + " bytes from " + String(totalHeap) + " bytes)\n");
 
-    // Get the file system information
+    // Get the file system information .. skipped while the other core writes the flash
+    FsLock lock(false);
+    if (lock.isLocked() == false) {
+        out.print("\nFile System Info: busy\n");
+        return;
+    }
     LittleFS.begin();
 
     // Get the file system information
@@ -360,34 +373,29 @@ String SystemInfo::dump(uint32_t now_ms, uint32_t userID) const {
             fsBar += " ";
         }
 
-        output += "\nFile System Info:\n";
-        output += "  File System Size: " + String(fileSystemSize) + " bytes\n";
-        output += "  File System Used: " + String(fileSystemUsed) + " bytes\n";
-        output += "  File System Free Space: " + String(fileSystemFreeSpace) + " bytes\n";
-        output += "File System: [" + fsBar + "] " + String(fsUsagePercentage, 1) + "% (used " + String(fileSystemUsed) + " bytes from " + String(fileSystemSize) + " bytes)\n";
-
-        // Get the file list from the root directory
-        String fileList = _getFileList("/","    ");
+        out.print("\nFile System Info:\n");
+        out.print("  File System Size: " + String(fileSystemSize) + " bytes\n");
+        out.print("  File System Used: " + String(fileSystemUsed) + " bytes\n");
+        out.print("  File System Free Space: " + String(fileSystemFreeSpace) + " bytes\n");
+        out.print("File System: [" + fsBar + "] " + String(fsUsagePercentage, 1) + "% (used " + String(fileSystemUsed) + " bytes from " + String(fileSystemSize) + " bytes)\n");
 
-        output += "  File List:\n" + fileList;
+        // print the file list of the root directory entry by entry
+        out.print("  File List:\n");
+        _printFileList(out, "    ");
     }
-
-    return output;
 }
 
-String SystemInfo::_getFileList(const String& path, const String & ident) const{
-    String result = "";
-    Dir dir = LittleFS.openDir(path);
-
-    while (dir.next()) {
-        if (dir.isDirectory()) {
-            result += ident + path + dir.fileName() + "/\n";
-            result += _getFileList(path + dir.fileName() + "/", ident + String("  ")); // Recursive call for subdirectories
+void SystemInfo::_printFileList(Print& out, const String& ident) const{
+    // cached .. the file system is walked only after a change
+    fsStatCache.forEach(0, SIZE_MAX, [&out, &ident](const FsStatEntry& entry) {
+        String entryIdent = ident;
+        for (uint8_t i = 0; i < entry.depth; i++) {
+            entryIdent += "  ";
+        }
+        if (entry.isDirectory) {
+            out.print(entryIdent + entry.path + "\n");
         } else {
-            result += ident + path + dir.fileName() + " : " + String(dir.fileSize()) + "bytes  \n";
+            out.print(entryIdent + entry.path + " : " + String(entry.size) + "bytes  \n");
         }
-    }
-    return result;
+    });
 }
-
-
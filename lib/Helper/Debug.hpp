@@ -168,9 +168,39 @@ extern Debug debug;
  */
 typedef std::function<String(uint32_t,uint32_t)> DumpFunctionPointer_t;
 
+/**
+ * @typedef DumpStreamFunctionPointer_t
+ * @brief optional streaming variant of a dump function.
+ * 
+ * prints the dump information directly to `out` instead of building a `String`,
+ * so long dumps (i.e. file lists) do not need RAM proportional to their size.
+ */
+typedef std::function<void(Print&,uint32_t,uint32_t)> DumpStreamFunctionPointer_t;
+
 struct dumpEntry_struct{
-    DumpFunctionPointer_t   p;
-    uint32_t                userID;
+    DumpFunctionPointer_t       p;
+    DumpStreamFunctionPointer_t s;      // optional (nullptr: the result of p is printed)
+    uint32_t                    userID;
+};
+
+
+/**
+ * @class StringPrint
+ * @brief A Print target that collects everything in a String (bridge from stream dumps to String dumps).
+ */
+class StringPrint : public Print {
+    public:
+        size_t write(uint8_t value) override {
+            str += (char)value;
+            return 1;
+        }
+        size_t write(const uint8_t * pBuffer, size_t size) override {
+            str.concat((const char *)pBuffer, size);
+            return size;
+        }
+        using Print::write;
+
+        String str;
 };
 
 
@@ -229,9 +259,10 @@ class Dumper {
          * @param name The unique name for the dump function.
          * @param func The dump function to register.
          * @param userID an optional user ID that can be used identify source of call if one functionm is registered more than one time
+         * @param stream optional streaming variant of func (see streamDumpFunction)
          * @throws throw log message if name already exist .. no overwrite / no registration
          */
-        void registerDumpFunction(const String& name, DumpFunctionPointer_t func, uint32_t userID=0) {
+        void registerDumpFunction(const String& name, DumpFunctionPointer_t func, uint32_t userID=0, DumpStreamFunctionPointer_t stream=nullptr) {
             if (name =="") return;  // no registration wanted
             String _name = name;
             if (_dumpFunctions.find(_name) != _dumpFunctions.end()) {
@@ -239,6 +270,7 @@ class Dumper {
             }
             dumpEntry_struct elm;
             elm.p = func;
+            elm.s = stream;
             elm.userID = userID;
             _dumpFunctions[_name] = elm;
         }
@@ -270,6 +302,44 @@ class Dumper {
             return it->second.p(now_ms,it->second.userID);
         }
 
+        /**
+         * @brief Print the dump of a registered function to out (streaming variant if registered).
+         * @param name The name of the dump function to call.
+         * @param out target of the dump
+         * @param now_ms The current timestamp in milliseconds.
+         * @return false if no function is registered with the given name.
+         */
+        bool streamDumpFunction(const String& name, Print& out, uint32_t now_ms) const {
+            auto it = _dumpFunctions.find(name);
+            if (it == _dumpFunctions.end()) {
+                LOG("No dump function registered with name '" + name + "'.");
+                return false;
+            }
+            if (it->second.s != nullptr) {
+                it->second.s(out,now_ms,it->second.userID);
+            } else {
+                out.print(it->second.p(now_ms,it->second.userID));
+            }
+            return true;
+        }
+
+        /**
+         * @brief Print all registered dump function names to out, separated by commas.
+         */
+        void list(Print& out) const {
+            bool first = true;
+            for (const auto& entry : _dumpFunctions) {
+                if (first == false) {
+                    out.print(", ");
+                }
+                out.print(entry.first);
+                first = false;
+            }
+            if (first == true) {
+                out.print("No registered dump functions.");
+            }
+        }
+
         /**
          * @brief List all registered dump function names.
          * @return A String containing all registered names, separated by commas.
@@ -327,6 +397,8 @@ class Dump {
         explicit Dump(const String& name) : _dumpName(name) {
             Dumper::getInstance().registerDumpFunction(_dumpName, [this](uint32_t now_msec,uint32_t userID) {
                 return this->dump(now_msec,userID);
+            }, 0, [this](Print& out, uint32_t now_msec,uint32_t userID) {
+                this->dumpTo(out,now_msec,userID);
             });
         }
     
@@ -344,6 +416,14 @@ class Dump {
          */
         virtual String dump(uint32_t now_ms,uint32_t userID) const = 0;
 
+        /**
+         * @brief Streaming variant of dump(), override it for long dumps.
+         * @param out target of the dump (i.e. the answer stream of a COM frame)
+         */
+        virtual void dumpTo(Print& out, uint32_t now_ms, uint32_t userID) const {
+            out.print(dump(now_ms,userID));
+        }
+
         String getDumpName() const {return _dumpName;}
     
     protected:
@@ -382,8 +462,13 @@ class SystemInfo : public Dump {
          * @return A String containing the system status information.
          */
         String dump(uint32_t now_ms, uint32_t userID) const override;
+
+        /**
+         * @brief Streaming variant of dump() .. the file list is printed entry by entry.
+         */
+        void dumpTo(Print& out, uint32_t now_ms, uint32_t userID) const override;
     private:
-        String _getFileList(const String& path="/", const String & ident="") const;
+        void _printFileList(Print& out, const String & ident="") const;
 };
 
 extern Dumper& dumper;
@@ -0,0 +1,91 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 MonkeyCodeMen@GitHub
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * provided to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#pragma once
+#include <Arduino.h>
+
+/*
+    string with fixed capacity and inline buffer .. no heap allocation at all
+    content is always zero terminated, append beyond capacity is refused (returns false)
+
+    used for the hot path of the COM frame parser, where an Arduino String
+    would grow (realloc) with every received char
+*/
+
+template<size_t N>
+class FixedString {
+public:
+    FixedString()                               { clear();                                      }
+    FixedString(const char * str)               { assign(str);                                  }
+    FixedString(const FixedString & src) = default;
+    ~FixedString() = default;
+
+    void clear()                                { _length = 0;  _buffer[0] = 0;                 }
+
+    bool assign(const char * str)               { clear(); return append(str);                  }
+    bool assign(const char * str,size_t length) { clear(); return append(str,length);           }
+
+    bool append(char c) {
+        if (_length >= N) return false;
+        _buffer[_length++] = c;
+        _buffer[_length]   = 0;
+        return true;
+    }
+
+    bool append(const char * str,size_t length) {
+        bool res = true;
+        if (length > N - _length) {
+            length = N - _length;
+            res = false;
+        }
+        memcpy(&_buffer[_length], str, length);
+        _length += length;
+        _buffer[_length] = 0;
+        return res;
+    }
+
+    bool append(const char * str)               { return (str == NULL) ? true : append(str,strlen(str)); }
+
+    FixedString & operator=(const FixedString & src) = default;
+    FixedString & operator=(const char * str)   { assign(str);                    return *this; }
+    FixedString & operator=(const String & str) { assign(str.c_str(),str.length()); return *this; }
+    FixedString & operator+=(char c)            { append(c);                      return *this; }
+    FixedString & operator+=(const char * str)  { append(str);                    return *this; }
+
+    bool operator==(const char * str) const     { return strcmp(_buffer, str) == 0;            }
+    bool operator!=(const char * str) const     { return strcmp(_buffer, str) != 0;            }
+    char operator[](size_t i) const             { return (i < _length) ? _buffer[i] : 0;       }
+
+    const char * c_str() const                  { return _buffer;                               }
+    size_t length() const                       { return _length;                               }
+    size_t capacity() const                     { return N;                                     }
+    bool isEmpty() const                        { return _length == 0;                          }
+    bool isFull() const                         { return _length >= N;                          }
+
+private:
+    char    _buffer[N+1];
+    size_t  _length;
+};
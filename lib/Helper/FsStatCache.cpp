@@ -0,0 +1,89 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 MonkeyCodeMen@GitHub
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * provided to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include "FsStatCache.hpp"
+
+FsStatCache fsStatCache;
+
+size_t FsStatCache::count() {
+    CoreLock lock(&_mutex);
+    _update();
+    return _entries.size();
+}
+
+uint32_t FsStatCache::generation() {
+    CoreLock lock(&_mutex);
+    _update();
+    return _generation;
+}
+
+size_t FsStatCache::forEach(size_t first, size_t maxCount, std::function<void(const FsStatEntry&)> func) {
+    FsStatEntry batch[FS_STAT_CACHE_BATCH];
+    size_t visited = 0;
+
+    while (visited < maxCount) {
+        size_t count = 0;
+        {
+            CoreLock lock(&_mutex);
+            _update();
+            for (size_t i = first + visited; (i < _entries.size()) && (count < FS_STAT_CACHE_BATCH) && (visited + count < maxCount); i++) {
+                batch[count++] = _entries[i];
+            }
+        }
+        for (size_t i = 0; i < count; i++) {
+            func(batch[i]);
+        }
+        visited += count;
+        if (count < FS_STAT_CACHE_BATCH) break;
+    }
+    return visited;
+}
+
+// call with locked mutex (and FsLock)
+void FsStatCache::_update() {
+    if (_valid == true) return;
+
+    // clear the flag before the walk .. an invalidate() during the walk triggers the next update
+    _valid = true;
+    _entries.clear();
+    _walk(String("/"), 0);
+    _entries.shrink_to_fit();
+    _generation++;
+}
+
+void FsStatCache::_walk(const String& path, uint8_t depth) {
+    Dir dir = LittleFS.openDir(path);
+
+    while (dir.next()) {
+        if (dir.isDirectory()) {
+            String subPath = path + dir.fileName() + "/";
+            _entries.push_back({subPath, 0, depth, true});
+            _walk(subPath, depth + 1);
+        } else {
+            _entries.push_back({path + dir.fileName(), (uint32_t)dir.fileSize(), depth, false});
+        }
+    }
+}
@@ -0,0 +1,82 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 MonkeyCodeMen@GitHub
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * provided to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#pragma once
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <vector>
+#include <functional>
+#include <CoreLock.hpp>
+
+/*
+    cached recursive directory listing of LittleFS (path, size, depth of every entry)
+
+    the file system is walked only on the first access after invalidate(), so a listing
+    costs the same for 10 or 500 files. Everyone who creates, writes or removes files
+    has to call invalidate() (LittleFsCOM, Config, LogFile).
+    The generation changes with every rebuild, a cursor of a paginated listing is only
+    valid for the same generation.
+
+    the first access after invalidate() walks the whole tree in the caller (known cost: core1 for
+    FILE list/ls, several ms with hundreds of files). Callers hold FsLock, the cache itself is
+    guarded by a CoreLock; forEach() copies the entries out in batches of FS_STAT_CACHE_BATCH,
+    func runs without the lock (it may print into a COM answer).
+*/
+
+#ifndef FS_STAT_CACHE_BATCH
+#define FS_STAT_CACHE_BATCH     8
+#endif
+
+struct FsStatEntry {
+    String   path;          // complete path, directories end with '/'
+    uint32_t size;          // [bytes] 0 for directories
+    uint8_t  depth;         // 0: entry of the root directory
+    bool     isDirectory;
+};
+
+class FsStatCache {
+public:
+    FsStatCache()                   { recursive_mutex_init(&_mutex);        }
+    ~FsStatCache() = default;
+
+    void     invalidate()           { _valid = false;                       }
+    size_t   count();
+    uint32_t generation();
+
+    // calls func for max. maxCount entries starting at index first .. returns number of visited entries
+    size_t   forEach(size_t first, size_t maxCount, std::function<void(const FsStatEntry&)> func);
+
+private:
+    void _update();
+    void _walk(const String& path, uint8_t depth);
+
+    std::vector<FsStatEntry>    _entries;
+    volatile bool               _valid = false;
+    uint32_t                    _generation = 0;
+    recursive_mutex_t           _mutex;
+};
+
+extern FsStatCache fsStatCache;
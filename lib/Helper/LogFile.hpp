@@ -1,6 +1,7 @@
 #pragma once
 #include <Arduino.h>
 #include <LittleFS.h>
+#include <FsStatCache.hpp>
 #include <vector>
 #include <string>
 
@@ -47,6 +48,7 @@ protected:
         if (!LittleFS.exists(_fileName))
         {
             File file = LittleFS.open(_fileName, "w");
+            fsStatCache.invalidate();
             file.close();
         }
     }
@@ -134,6 +136,7 @@ private:
     void writeToFile() override
     {
         File file = LittleFS.open(_fileName, "w");
+        fsStatCache.invalidate();
         if (!file)
             return;
 
@@ -190,6 +193,7 @@ private:
     void writeToFile() override
     {
         File file = LittleFS.open(_fileName, "w");
+        fsStatCache.invalidate();
         if (!file)
             return;
 
@@ -274,6 +278,7 @@ private:
     void writeToCSV()
     {
         File file = LittleFS.open(_fileName, "w");
+        fsStatCache.invalidate();
         if (!file)
             return;
 
@@ -307,6 +312,7 @@ private:
     void writeToBinary()
     {
         File file = LittleFS.open(_fileName, "w");
+        fsStatCache.invalidate();
         if (!file)
             return;
 
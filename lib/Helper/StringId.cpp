@@ -63,3 +63,12 @@ uint32_t StringID::getID(const char* name) {
     _mutex.free();
     return 0;
 }
+
+// all registered strings .. func must not call StringID (mutex is locked)
+void StringID::forEach(std::function<void(uint32_t id, const char* name)> func) {
+    _mutex.lock();
+    for (auto& entry : _hashToString) {
+        func(entry.first, entry.second);
+    }
+    _mutex.free();
+}
@@ -2,6 +2,7 @@
 
 #include <Arduino.h>
 #include <unordered_map>
+#include <functional>
 #include <Mutex.hpp> // Für Thread-Sicherheit
 
 class StringID {
@@ -20,6 +21,9 @@ public:
     uint32_t getID(const char* name);
     uint32_t getID(const String& name) { return getID(name.c_str()); }
 
+    // calls func for every registered string (e.g. to build a filter of known config keys)
+    void forEach(std::function<void(uint32_t id, const char* name)> func);
+
 
 private:
     // Privater Konstruktor für Singleton
@@ -368,3 +368,179 @@ uint32_t stringHash(const String& str) {
     }
     return hash;
 }
+
+uint32_t stringHash(const char * str) {
+    uint32_t hash = 5381;
+    while (*str != 0) {
+        hash = ((hash << 5) + hash) + *str++; // hash * 33 + c
+    }
+    return hash;
+}
+
+
+// CRC-16/CCITT-FALSE, bitwise (no table to keep flash/RAM footprint small)
+uint16_t crc16(const uint8_t * p, size_t length, uint16_t crc) {
+    while (length--) {
+        crc ^= (uint16_t)(*p++) << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+// CRC-32 (reflected poly 0xEDB88320), nibble table: 64 bytes of flash and two lookups per byte
+uint32_t crc32(const uint8_t * p, size_t length, uint32_t crc) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    crc = ~crc;
+    while (length--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+// Adler-32 (zlib), NMAX bytes between the modulo operations
+uint32_t adler32(const uint8_t * p, size_t length, uint32_t adler) {
+    const uint32_t BASE = 65521;
+    const size_t   NMAX = 5552;         // largest n with 255n(n+1)/2 + (n+1)(BASE-1) < 2^32
+    uint32_t a = adler & 0xFFFF;
+    uint32_t b = adler >> 16;
+
+    while (length > 0) {
+        size_t n = (length < NMAX) ? length : NMAX;
+        length -= n;
+        while (n--) {
+            a += *p++;
+            b += a;
+        }
+        a %= BASE;
+        b %= BASE;
+    }
+    return (b << 16) | a;
+}
+
+// LZF (format of liblzf / Python lzf) .. literal runs of max 32 bytes, back references of 3..264 bytes within 8 kB
+#define LZF_MAX_LIT     (1 << 5)
+#define LZF_MAX_OFF     (1 << 13)
+#define LZF_MAX_REF     ((1 << 8) + (1 << 3))
+#define LZF_IDX(h)      ((((h) >> (3*8 - LZF_HLOG)) - (h) * 5) & (LZF_HASH_SIZE - 1))
+
+size_t lzfCompress(const uint8_t * pIn, size_t inLength, uint8_t * pOut, size_t outLength, uint16_t * pTable) {
+    const uint8_t * ip = pIn;
+    const uint8_t * inEnd = pIn + inLength;
+    uint8_t * op = pOut;
+    uint8_t * outEnd = pOut + outLength;
+    int lit = 0;
+
+    if ((inLength == 0) || (inLength > 0xFFFF) || (outLength == 0)) return 0;
+    memset(pTable, 0, LZF_HASH_SIZE * sizeof(uint16_t));
+
+    op++;                               // start literal run
+    while (ip + 2 < inEnd) {
+        uint32_t hval = (ip[0] << 16) | (ip[1] << 8) | ip[2];
+        uint16_t * pSlot = &pTable[LZF_IDX(hval)];
+        const uint8_t * ref = pIn + *pSlot;
+        *pSlot = ip - pIn;
+
+        uint32_t off = ip - ref - 1;
+        if ((ref < ip) && (ref > pIn) && (off < LZF_MAX_OFF) && (ref[0] == ip[0]) && (ref[1] == ip[1]) && (ref[2] == ip[2])) {
+            uint32_t len = 2;
+            uint32_t maxLen = inEnd - ip - len;
+            maxLen = (maxLen > LZF_MAX_REF) ? LZF_MAX_REF : maxLen;
+
+            if (op - !lit + 3 + 1 >= outEnd) return 0;
+
+            op[-lit - 1] = lit - 1;     // stop literal run
+            op -= !lit;                 // undo empty run
+            do {
+                len++;
+            } while ((len < maxLen) && (ref[len] == ip[len]));
+
+            len -= 2;                   // length - 1
+            ip++;
+            if (len < 7) {
+                *op++ = (off >> 8) + (len << 5);
+            } else {
+                *op++ = (off >> 8) + (7 << 5);
+                *op++ = len - 7;
+            }
+            *op++ = off;
+
+            lit = 0;
+            op++;                       // start literal run
+            ip += len + 1;
+            if (ip + 2 >= inEnd) break;
+
+            // hash the last position of the match too
+            --ip;
+            hval = (ip[0] << 16) | (ip[1] << 8) | ip[2];
+            pTable[LZF_IDX(hval)] = ip - pIn;
+            ip++;
+        } else {
+            if (op >= outEnd) return 0;
+            lit++;
+            *op++ = *ip++;
+            if (lit == LZF_MAX_LIT) {
+                op[-lit - 1] = lit - 1;
+                lit = 0;
+                op++;
+            }
+        }
+    }
+
+    if (op + 3 > outEnd) return 0;      // max. 3 bytes left
+    while (ip < inEnd) {
+        lit++;
+        *op++ = *ip++;
+        if (lit == LZF_MAX_LIT) {
+            op[-lit - 1] = lit - 1;
+            lit = 0;
+            op++;
+        }
+    }
+    op[-lit - 1] = lit - 1;             // end literal run
+    op -= !lit;
+
+    return op - pOut;
+}
+
+size_t lzfDecompress(const uint8_t * pIn, size_t inLength, uint8_t * pOut, size_t outLength) {
+    const uint8_t * ip = pIn;
+    const uint8_t * inEnd = pIn + inLength;
+    uint8_t * op = pOut;
+    uint8_t * outEnd = pOut + outLength;
+
+    while (ip < inEnd) {
+        uint32_t ctrl = *ip++;
+
+        if (ctrl < (1 << 5)) {
+            // literal run of ctrl+1 bytes
+            ctrl++;
+            if ((op + ctrl > outEnd) || (ip + ctrl > inEnd)) return 0;
+            memcpy(op, ip, ctrl);
+            op += ctrl;
+            ip += ctrl;
+        } else {
+            // back reference (can overlap the output)
+            uint32_t len = ctrl >> 5;
+            const uint8_t * ref = op - ((ctrl & 0x1F) << 8) - 1;
+            if (len == 7) {
+                if (ip >= inEnd) return 0;
+                len += *ip++;
+            }
+            if (ip >= inEnd) return 0;
+            ref -= *ip++;
+            len += 2;
+            if ((op + len > outEnd) || (ref < pOut)) return 0;
+            while (len--) {
+                *op++ = *ref++;
+            }
+        }
+    }
+    return op - pOut;
+}
@@ -104,4 +104,22 @@ String removeTrailingCharacters(String input, char charToRemove);
 String removeTrailingCharacters(String input, const String& charsToRemove);
 
 // Custom hash function for Arduino String type
-uint32_t stringHash(const String& str);
\ No newline at end of file
+uint32_t stringHash(const String& str);
+uint32_t stringHash(const char * str);          // same hash value as String version, but without a String copy
+
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) .. pass the last result as crc to continue over several blocks
+uint16_t crc16(const uint8_t * p, size_t length, uint16_t crc = 0xFFFF);
+
+// CRC-32 (IEEE 802.3, same as zlib/Python binascii.crc32) .. pass the last result as crc to continue over several blocks
+uint32_t crc32(const uint8_t * p, size_t length, uint32_t crc = 0);
+
+// Adler-32 (same as zlib/Python zlib.adler32), weak block checksum that a host can roll over its file byte by byte
+uint32_t adler32(const uint8_t * p, size_t length, uint32_t adler = 1);
+
+// LZF compression (same format as liblzf / Python lzf), small and fast .. fits chunks of a file transfer
+// returns the compressed/decompressed length or 0 (output buffer too small, data not compressible, corrupt input)
+// pTable: work area of LZF_HASH_SIZE entries, inLength max 65535
+#define LZF_HLOG        10
+#define LZF_HASH_SIZE   (1 << LZF_HLOG)
+size_t lzfCompress(const uint8_t * pIn, size_t inLength, uint8_t * pOut, size_t outLength, uint16_t * pTable);
+size_t lzfDecompress(const uint8_t * pIn, size_t inLength, uint8_t * pOut, size_t outLength);
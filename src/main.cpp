@@ -86,6 +86,10 @@ Button * pButton;
 WS2812FX stripe = WS2812FX(32, PIN_WS2812B, NEO_GRB + NEO_KHZ800);
 MyInfo myInfo;
 
+#ifdef COM_AUX_SERIAL
+Com comAux("ComAux", &comDispatch, COM_AUX_MAX_DATA_LENGTH);   // second COM link .. shares the modules with com
+#endif
+
 enum   {
     LED_MODE_OFF=0,
     LED_MODE_ON
@@ -157,7 +161,10 @@ void setup()
 
     LOG(F("setup 0: load config"));
     config.begin(); // Initialize the configuration file system
-    if (config.load())
+    config.useJournal("/Curie-Bottle.jnl");     // single key changes are small appends, the JSON file stays as export
+    JsonDocument configFilter;                  // only the keys of this firmware (DEFINE_STRING_ID), shared config files carry more
+    Config::buildStringIdFilter(configFilter);
+    if (config.load(&configFilter))
     {
         LOG(F("setup 0: config loaded"));
         msgConfig = F("setup 0: config loaded");
@@ -167,6 +174,8 @@ void setup()
         setDefaultConfig();
         config.save();
     }
+    msgConfig += " from " + String(config.getLoadSource()) + " in " + String(config.getLoadTime_us()) + " us";
+    config.setAutosave(CONFIG_AUTOSAVE_DELAY_MS);   // changes at runtime are written once per burst
 
     
     LOG(F("setup 0: setup first core done, start setup of second core"));
@@ -180,6 +189,7 @@ void setup()
     stripe.setSpeed(20);
     stripe.setMode(FX_MODE_RAINBOW_CYCLE);
     stripe.start();
+    LOG("setup 0: LED stripe started at " + String(millis()) + " ms (config load " + String(config.getLoadTime_us()) + " us)");
 
     LOG(F("setup 0: start loop of first core"));
     blink.setup(BLINK_SEQ_MAIN);
@@ -205,6 +215,9 @@ void setup1()
     // register available modules for this project
     com.addModule(new LittleFsCOM());
     com.addModule(new ComModuleDump());
+    #ifdef COM_AUX_SERIAL
+        comAux.begin(&COM_AUX_SERIAL, COM_AUX_BAUDRATE, SERIAL_8N1,"Pico Battery Balancer V1.0 ready (aux)");
+    #endif
 
     LOG(F("setup 1: setup second core done"));
     waitForsecondCore = false;
@@ -224,6 +237,8 @@ void loop()
     // loops
     blink.loop(now);
     pButton->loop(now);
+    comWorker.loop();       // background COM commands (flash write/erase) .. keeps them away from stripe.service() on core1
+    config.loop(now);       // debounced autosave, also a flash write .. core0, holds the config and file system locks
 
     switch (status) {
         case LED_MODE_OFF:
@@ -261,6 +276,9 @@ void loop1()
  
     // getter functions of  WS2812FX should be thread safe
     com.loop(now); 
+    #ifdef COM_AUX_SERIAL
+        comAux.loop(now);
+    #endif
   
 
 }
@@ -0,0 +1,21 @@
+/*
+    counts the heap allocations of the test program (replaces the global operator new)
+    include it in exactly one source file of a test
+*/
+#pragma once
+#include <new>
+#include <stdlib.h>
+
+inline volatile unsigned long allocCount = 0;
+
+void * operator new(size_t size) {
+    allocCount++;
+    void * p = malloc((size > 0) ? size : 1);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+void * operator new[](size_t size)                  { return operator new(size); }
+void operator delete(void * p) noexcept             { free(p); }
+void operator delete[](void * p) noexcept           { free(p); }
+void operator delete(void * p, size_t) noexcept     { free(p); }
+void operator delete[](void * p, size_t) noexcept   { free(p); }
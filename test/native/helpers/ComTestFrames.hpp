@@ -0,0 +1,41 @@
+/*
+    synthetic requests for the native COM tests and the benchmark
+*/
+#pragma once
+#include <Arduino.h>
+#include <ComBinary.hpp>
+#include <MockStream.hpp>
+
+#define COM_TEST_MODULE     'E'
+#define COM_TEST_COMMAND    "echo"
+#define COM_TEST_STR        "benchmark text parameter"
+
+inline size_t comTestAsciiRequest(uint8_t * pBuffer, size_t size) {
+    int length = snprintf((char *)pBuffer, size, "S:%c0@4711,%s,0x12345678,1000,-1,0xAB,\"%s\"#", COM_TEST_MODULE, COM_TEST_COMMAND, COM_TEST_STR);
+    return (length > 0) ? (size_t)length : 0;
+}
+
+inline size_t comTestBinaryRequest(uint8_t * pBuffer, size_t size) {
+    uint8_t  cmdLength = strlen(COM_TEST_COMMAND);
+    uint16_t strLength = strlen(COM_TEST_STR);
+    MockBuffer buffer(pBuffer, size);
+    ComBinaryWriter writer(&buffer);
+    writer.begin();
+    writer.put(COM_BIN_TYPE_REQUEST);
+    writer.put((uint8_t)COM_TEST_MODULE);
+    writer.put(0);
+    writer.put(COM_BIN_FLAG_WITH_PAR | COM_BIN_FLAG_TAGGED);
+    writer.putUint16(COM_BIN_HEADER_LENGTH + cmdLength + strLength);
+    writer.put(cmdLength);
+    writer.putUint16(strLength);
+    writer.putUint16(0);
+    writer.putUint32(0x12345678);
+    writer.putUint32(1000);
+    writer.putUint32(0xFFFFFFFF);
+    writer.putUint32(0xAB);
+    writer.putUint16(4711);
+    writer.put((const uint8_t *)COM_TEST_COMMAND, cmdLength);
+    writer.put((const uint8_t *)COM_TEST_STR, strLength);
+    writer.end();
+    return buffer.length;
+}
@@ -0,0 +1,58 @@
+/*
+    memory stream for the native tests
+
+    the receive side returns the bytes of feed() (repeated with feed() again), everything written
+    is counted and kept in tx (unless capture is false, i.e. for long benchmark runs)
+    closed: write takes no byte, like USB CDC after the host has closed the port
+*/
+#pragma once
+#include <Arduino.h>
+#include <string>
+
+class MockStream : public Stream {
+public:
+    MockStream() : txBytes(0), capture(true), closed(false), _pRx(nullptr), _length(0), _pos(0) {}
+
+    // the buffer must stay valid while it is read
+    void feed(const uint8_t * pBuffer, size_t length)   { _pRx = pBuffer; _length = length; _pos = 0; }
+    void feed()                                         { _pos = 0; }
+
+    int available() override                           { return _length - _pos; }
+    int read() override                                 { return (_pos < _length) ? _pRx[_pos++] : -1; }
+    int peek() override                                 { return (_pos < _length) ? _pRx[_pos]   : -1; }
+    int availableForWrite() override                    { return 0x7FFF; }
+    size_t write(uint8_t value) override                { return write(&value, 1); }
+    size_t write(const uint8_t * pBuffer, size_t size) override {
+        if (closed == true) return 0;
+        txBytes += size;
+        if (capture == true) tx.append((const char *)pBuffer, size);
+        return size;
+    }
+    using Print::write;
+
+    std::string tx;
+    uint64_t    txBytes;
+    bool        capture;
+    bool        closed;
+
+private:
+    const uint8_t * _pRx;
+    size_t          _length;
+    size_t          _pos;
+};
+
+// Print target to build a request (i.e. binary frame) in RAM
+class MockBuffer : public Print {
+public:
+    MockBuffer(uint8_t * pBuffer, size_t size) : length(0), _pBuffer(pBuffer), _size(size) {}
+    size_t write(uint8_t value) override {
+        if (length >= _size) return 0;
+        _pBuffer[length++] = value;
+        return 1;
+    }
+    using Print::write;
+    size_t length;
+private:
+    uint8_t * _pBuffer;
+    size_t    _size;
+};
@@ -0,0 +1,175 @@
+/*
+    Arduino shim for the native (host) tests .. only what lib/Com and lib/Helper need
+
+    String is based on std::string, Print formats numbers without heap (as the Arduino core does),
+    so allocation counts of the tests match the target.
+*/
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <string>
+#include <chrono>
+#include <type_traits>
+
+class __FlashStringHelper;
+#define F(x)        (reinterpret_cast<const __FlashStringHelper *>(x))
+
+#define HEX         16
+#define DEC         10
+#define SERIAL_8N1  0x06
+
+class String {
+public:
+    String() {}
+    String(const char * c) : _s(c ? c : "") {}
+    String(const String & o) = default;
+    String(char c) : _s(1, c) {}
+    String(const __FlashStringHelper * c) : _s((const char *)c) {}
+    String(int v, unsigned char base = 10)              { _fromNumber((long)v, base); }
+    String(unsigned int v, unsigned char base = 10)     { _fromNumber((unsigned long)v, base); }
+    String(long v, unsigned char base = 10)             { _fromNumber(v, base); }
+    String(unsigned long v, unsigned char base = 10)    { _fromNumber(v, base); }
+    String(double v, unsigned char digits = 2)          { char b[32]; snprintf(b, sizeof(b), "%.*f", digits, v); _s = b; }
+
+    String & operator=(const String & o) = default;
+    String & operator=(const char * c)                  { _s = c ? c : ""; return *this; }
+    String & operator+=(const String & o)               { _s += o._s; return *this; }
+    String & operator+=(const char * c)                 { _s += c; return *this; }
+    String & operator+=(char c)                         { _s += c; return *this; }
+    String & operator+=(int v)                          { _s += String(v)._s; return *this; }
+    String & operator+=(unsigned int v)                 { _s += String(v)._s; return *this; }
+    String & operator+=(long v)                         { _s += String(v)._s; return *this; }
+    String & operator+=(unsigned long v)                { _s += String(v)._s; return *this; }
+    bool concat(const char * c, unsigned int n)         { _s.append(c, n); return true; }
+    bool concat(const String & o)                       { _s += o._s; return true; }
+    bool concat(char c)                                 { _s += c; return true; }
+    bool reserve(unsigned int n)                        { _s.reserve(n); return true; }
+
+    friend String operator+(const String & a, const String & b) { String r(a); r += b; return r; }
+    friend String operator+(const String & a, const char * b)   { String r(a); r += b; return r; }
+    friend String operator+(const char * a, const String & b)   { String r(a); r += b; return r; }
+    friend String operator+(const String & a, char b)           { String r(a); r += b; return r; }
+    bool operator==(const String & o) const             { return _s == o._s; }
+    bool operator==(const char * c) const               { return _s == c; }
+    bool operator!=(const String & o) const             { return _s != o._s; }
+    bool operator!=(const char * c) const               { return _s != c; }
+    bool operator<(const String & o) const              { return _s < o._s; }
+    char operator[](unsigned int i) const               { return (i < _s.size()) ? _s[i] : 0; }
+    char & operator[](unsigned int i)                   { return _s[i]; }
+
+    char charAt(unsigned int i) const                   { return (*this)[i]; }
+    unsigned int length() const                         { return _s.size(); }
+    const char * c_str() const                          { return _s.c_str(); }
+    long toInt() const                                  { return atol(_s.c_str()); }
+    void toLowerCase()                                  { for (auto & c : _s) c = tolower(c); }
+    void toUpperCase()                                  { for (auto & c : _s) c = toupper(c); }
+    void trim() {
+        size_t first = _s.find_first_not_of(" \t\r\n");
+        if (first == std::string::npos) { _s.clear(); return; }
+        _s = _s.substr(first, _s.find_last_not_of(" \t\r\n") - first + 1);
+    }
+    String substring(unsigned int from) const           { return (from >= _s.size()) ? String() : String(_s.substr(from).c_str()); }
+    String substring(unsigned int from, unsigned int to) const { return (from >= _s.size()) ? String() : String(_s.substr(from, to - from).c_str()); }
+    int indexOf(char c, unsigned int from = 0) const    { size_t p = _s.find(c, from);    return (p == std::string::npos) ? -1 : (int)p; }
+    int indexOf(const String & c, unsigned int from = 0) const { size_t p = _s.find(c._s, from); return (p == std::string::npos) ? -1 : (int)p; }
+    int lastIndexOf(char c) const                       { size_t p = _s.rfind(c);         return (p == std::string::npos) ? -1 : (int)p; }
+    bool startsWith(const String & p) const             { return _s.rfind(p._s, 0) == 0; }
+    bool endsWith(const String & p) const               { return (_s.size() >= p._s.size()) && (_s.compare(_s.size() - p._s.size(), p._s.size(), p._s) == 0); }
+    void remove(unsigned int i)                         { if (i < _s.size()) _s.erase(i); }
+    void remove(unsigned int i, unsigned int n)         { if (i < _s.size()) _s.erase(i, n); }
+    bool isEmpty() const                                { return _s.empty(); }
+
+private:
+    template<class T> void _fromNumber(T v, int base) {
+        char b[40];
+        if (base == 16) snprintf(b, sizeof(b), "%lX", (unsigned long)v);
+        else            snprintf(b, sizeof(b), "%ld", (long)v);
+        _s = b;
+    }
+    std::string _s;
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t) = 0;
+    virtual size_t write(const uint8_t * b, size_t n)   { size_t r = 0; while (n--) r += write(*b++); return r; }
+    size_t write(const char * s)                        { return write((const uint8_t *)s, strlen(s)); }
+    size_t write(const char * s, size_t n)              { return write((const uint8_t *)s, n); }
+    virtual int availableForWrite()                     { return 0; }
+    virtual void flush() {}
+
+    size_t print(const String & s)                      { return write((const uint8_t *)s.c_str(), s.length()); }
+    size_t print(const char * s)                        { return write(s); }
+    size_t print(const __FlashStringHelper * s)         { return write((const char *)s); }
+    size_t print(char c)                                { return write((uint8_t)c); }
+    size_t print(int v, int base = DEC)                 { return (v < 0) && (base == DEC) ? print('-') + _printNumber(-(long)v, base) : _printNumber((unsigned int)v, base); }
+    size_t print(unsigned int v, int base = DEC)        { return _printNumber(v, base); }
+    size_t print(long v, int base = DEC)                { return (v < 0) && (base == DEC) ? print('-') + _printNumber(-v, base) : _printNumber((unsigned long)v, base); }
+    size_t print(unsigned long v, int base = DEC)       { return _printNumber(v, base); }
+    size_t println(const String & s)                    { return print(s) + println(); }
+    size_t println(const char * s)                      { return print(s) + println(); }
+    size_t println()                                    { return print("\r\n"); }
+
+private:
+    size_t _printNumber(unsigned long v, int base) {
+        char buffer[8 * sizeof(long) + 1];
+        char * p = &buffer[sizeof(buffer) - 1];
+        *p = 0;
+        do {
+            char digit = v % base;
+            *--p = (digit < 10) ? ('0' + digit) : ('A' + digit - 10);
+            v /= base;
+        } while (v != 0);
+        return write(p);
+    }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    size_t readBytes(uint8_t * b, size_t n)             { size_t i = 0; while ((i < n) && (available() > 0)) b[i++] = read(); return i; }
+    size_t readBytes(char * b, size_t n)                { return readBytes((uint8_t *)b, n); }
+};
+
+class HardwareSerial : public Stream {
+public:
+    virtual void begin(unsigned long) {}
+    virtual void begin(unsigned long, uint16_t) {}
+    int available() override                            { return 0; }
+    int read() override                                 { return -1; }
+    int peek() override                                 { return -1; }
+    size_t write(uint8_t) override                      { return 1; }
+    using Print::write;
+};
+inline HardwareSerial Serial, Serial1, Serial2;
+
+inline unsigned long micros() {
+    static auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+inline unsigned long millis()                           { return micros() / 1000; }
+inline void delay(unsigned long) {}
+inline void yield() {}
+inline void noInterrupts() {}
+inline void interrupts() {}
+inline long random(long max)                            { return rand() % max; }
+inline long random(long min, long max)                  { return min + rand() % (max - min); }
+template<class A, class B> typename std::common_type<A, B>::type min(A a, B b) { return (a < b) ? a : b; }
+template<class A, class B> typename std::common_type<A, B>::type max(A a, B b) { return (a > b) ? a : b; }
+
+struct RP2040 {
+    uint32_t getFreeHeap()                              { return 0; }
+    uint32_t getUsedHeap()                              { return 0; }
+    uint32_t getTotalHeap()                             { return 0; }
+    uint32_t f_cpu()                                    { return 0; }
+    uint32_t getCycleCount()                            { return 0; }
+    const char * getChipID()                            { return "native"; }
+};
+inline RP2040 rp2040;
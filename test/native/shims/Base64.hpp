@@ -0,0 +1,47 @@
+/*
+    Base64 shim for the native (host) tests .. same interface as the Base64 library of the target
+*/
+#pragma once
+#include <string.h>
+
+inline const char * base64Table() { return "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"; }
+
+inline unsigned int encode_base64_length(unsigned int length) { return (length + 2) / 3 * 4; }
+
+inline unsigned int encode_base64(const unsigned char input[], unsigned int length, unsigned char output[]) {
+    const char * table = base64Table();
+    unsigned int o = 0;
+    for (unsigned int i = 0; i < length; i += 3) {
+        unsigned int v = (input[i] << 16) | ((i + 1 < length) ? (input[i + 1] << 8) : 0) | ((i + 2 < length) ? input[i + 2] : 0);
+        output[o++] = table[(v >> 18) & 63];
+        output[o++] = table[(v >> 12) & 63];
+        output[o++] = (i + 1 < length) ? table[(v >> 6) & 63] : '=';
+        output[o++] = (i + 2 < length) ? table[v & 63] : '=';
+    }
+    output[o] = 0;
+    return o;
+}
+
+inline unsigned int decode_base64_length(const unsigned char input[], unsigned int length) {
+    while ((length > 0) && (input[length - 1] == '=')) length--;
+    return length * 3 / 4;
+}
+inline unsigned int decode_base64_length(const unsigned char input[]) { return decode_base64_length(input, strlen((const char *)input)); }
+
+inline unsigned int decode_base64(const unsigned char input[], unsigned int length, unsigned char output[]) {
+    const char * table = base64Table();
+    unsigned int o = 0, v = 0, bits = 0;
+    while ((length > 0) && (input[length - 1] == '=')) length--;
+    for (unsigned int i = 0; i < length; i++) {
+        const char * p = (input[i] != 0) ? strchr(table, input[i]) : nullptr;
+        if (p == nullptr) continue;
+        v = (v << 6) | (p - table);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            output[o++] = (v >> bits) & 0xFF;
+        }
+    }
+    return o;
+}
+inline unsigned int decode_base64(const unsigned char input[], unsigned char output[]) { return decode_base64(input, strlen((const char *)input), output); }
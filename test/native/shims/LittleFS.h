@@ -0,0 +1,146 @@
+/*
+    LittleFS shim for the native (host) tests .. maps the file system to the directory native_littlefs
+    (or $NATIVE_LITTLEFS) of the host, enough for the file modules to build and run
+*/
+#pragma once
+#include <Arduino.h>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+#include <time.h>
+
+enum SeekMode { SeekSet, SeekCur, SeekEnd };
+
+namespace nativefs {
+    namespace fs = std::filesystem;
+    inline std::string root() {
+        const char * r = getenv("NATIVE_LITTLEFS");
+        return (r != nullptr) ? r : "native_littlefs";
+    }
+    inline std::string path(const char * p) {
+        while (*p == '/') p++;
+        return root() + "/" + p;
+    }
+    struct FileImpl {
+        FILE *      f = nullptr;
+        std::string name;
+        std::string full;
+        bool        dir = false;
+    };
+    struct DirImpl {
+        std::vector<fs::directory_entry> entries;
+        int index = -1;
+    };
+}
+
+class File : public Stream {
+public:
+    File() {}
+    operator bool() const                               { return _p && (_p->f || _p->dir); }
+    int available() override                            { return (_p && _p->f) ? (int)(size() - position()) : 0; }
+    int read() override                                 { uint8_t b; return (read(&b, 1) == 1) ? b : -1; }
+    int peek() override                                 { int c = read(); if (c >= 0) fseek(_p->f, -1, SEEK_CUR); return c; }
+    size_t write(uint8_t b) override                    { return write(&b, 1); }
+    size_t write(const uint8_t * b, size_t n) override  { return (_p && _p->f) ? fwrite(b, 1, n, _p->f) : 0; }
+    using Print::write;
+    size_t read(uint8_t * b, size_t n)                  { return (_p && _p->f) ? fread(b, 1, n, _p->f) : 0; }
+    bool seek(uint32_t o, SeekMode m = SeekSet)         { return (_p && _p->f) && (fseek(_p->f, o, (m == SeekSet) ? SEEK_SET : (m == SeekCur) ? SEEK_CUR : SEEK_END) == 0); }
+    size_t position() const                             { return (_p && _p->f) ? ftell(_p->f) : 0; }
+    size_t size() const {
+        if (!_p || !_p->f) return 0;
+        long current = ftell(_p->f);
+        fseek(_p->f, 0, SEEK_END);
+        long end = ftell(_p->f);
+        fseek(_p->f, current, SEEK_SET);
+        return end;
+    }
+    void close()                                        { if (_p && _p->f) fclose(_p->f); _p.reset(); }
+    void flush() override                               { if (_p && _p->f) fflush(_p->f); }
+    const char * name() const                           { return _p->name.c_str(); }
+    const char * fullName() const                       { return _p->name.c_str(); }
+    bool isDirectory() const                            { return _p && _p->dir; }
+    bool truncate(uint32_t n) {
+        if (!_p || !_p->f) return false;
+        fflush(_p->f);
+        std::error_code ec;
+        nativefs::fs::resize_file(_p->full, n, ec);
+        return !ec;
+    }
+    time_t getLastWrite()                               { return 0; }
+    File openNextFile()                                 { return File(); }
+
+    std::shared_ptr<nativefs::FileImpl> _p;
+};
+
+class Dir {
+public:
+    bool next()                                         { return _p && (++_p->index < (int)_p->entries.size()); }
+    bool isDirectory()                                  { return _p->entries[_p->index].is_directory(); }
+    bool isFile()                                       { return !isDirectory(); }
+    String fileName()                                   { return String(_p->entries[_p->index].path().filename().string().c_str()); }
+    size_t fileSize()                                   { return isDirectory() ? 0 : nativefs::fs::file_size(_p->entries[_p->index].path()); }
+    bool rewind()                                       { _p->index = -1; return true; }
+    time_t fileTime()                                   { return 0; }
+
+    std::shared_ptr<nativefs::DirImpl> _p;
+};
+
+struct FSInfo {
+    size_t totalBytes, usedBytes, blockSize, pageSize, maxOpenFiles, maxPathLength;
+};
+
+class FS {
+public:
+    bool begin()                                        { std::error_code ec; nativefs::fs::create_directories(nativefs::root(), ec); return !ec; }
+    void end() {}
+    bool info(FSInfo & i)                               { i = FSInfo{512 * 1024, 0, 4096, 256, 16, 255}; return true; }
+
+    File open(const String & p, const char * mode)      { return open(p.c_str(), mode); }
+    File open(const char * p, const char * mode) {
+        File file;
+        std::string full = nativefs::path(p);
+        std::string m = mode;
+        std::error_code ec;
+        if (nativefs::fs::is_directory(full, ec)) {
+            file._p = std::make_shared<nativefs::FileImpl>();
+            file._p->dir  = true;
+            file._p->name = p;
+            return file;
+        }
+        if (m != "r") nativefs::fs::create_directories(nativefs::fs::path(full).parent_path(), ec);
+        const char * cmode = (m == "r") ? "rb" : (m == "w") ? "wb" : (m == "a") ? "ab" : (m == "r+") ? "r+b" : (m == "w+") ? "w+b" : "a+b";
+        FILE * f = fopen(full.c_str(), cmode);
+        if (f == nullptr) return file;
+        file._p = std::make_shared<nativefs::FileImpl>();
+        file._p->f    = f;
+        file._p->name = p;
+        file._p->full = full;
+        return file;
+    }
+    bool exists(const String & p)                       { return exists(p.c_str()); }
+    bool exists(const char * p)                         { std::error_code ec; return nativefs::fs::exists(nativefs::path(p), ec); }
+    Dir openDir(const String & p)                       { return openDir(p.c_str()); }
+    Dir openDir(const char * p) {
+        Dir dir;
+        dir._p = std::make_shared<nativefs::DirImpl>();
+        std::error_code ec;
+        for (auto & entry : nativefs::fs::directory_iterator(nativefs::path(p), ec)) dir._p->entries.push_back(entry);
+        std::sort(dir._p->entries.begin(), dir._p->entries.end());
+        return dir;
+    }
+    bool remove(const String & p)                       { return remove(p.c_str()); }
+    bool remove(const char * p) {
+        std::error_code ec;
+        std::string full = nativefs::path(p);
+        if (nativefs::fs::is_directory(full, ec)) return false;
+        return nativefs::fs::remove(full, ec);
+    }
+    bool rename(const String & a, const String & b)     { return rename(a.c_str(), b.c_str()); }
+    bool rename(const char * a, const char * b)         { std::error_code ec; nativefs::fs::rename(nativefs::path(a), nativefs::path(b), ec); return !ec; }
+    bool mkdir(const String & p)                        { return mkdir(p.c_str()); }
+    bool mkdir(const char * p)                          { std::error_code ec; nativefs::fs::create_directories(nativefs::path(p), ec); return !ec; }
+    bool rmdir(const String & p)                        { return rmdir(p.c_str()); }
+    bool rmdir(const char * p)                          { std::error_code ec; return nativefs::fs::remove(nativefs::path(p), ec); }
+};
+inline FS LittleFS;
@@ -0,0 +1,16 @@
+/*
+    pico SDK mutex shim for the native (host) tests .. the tests run on one thread, the lock only counts
+*/
+#pragma once
+#include <cstdint>
+
+typedef struct {
+    uint32_t enter_count;
+} recursive_mutex_t;
+
+inline void recursive_mutex_init(recursive_mutex_t * pMutex)                           { pMutex->enter_count = 0; }
+inline void recursive_mutex_enter_blocking(recursive_mutex_t * pMutex)                 { pMutex->enter_count++; }
+inline bool recursive_mutex_try_enter(recursive_mutex_t * pMutex, uint32_t * pOwner)   { (void)pOwner; pMutex->enter_count++; return true; }
+inline void recursive_mutex_exit(recursive_mutex_t * pMutex)                           { pMutex->enter_count--; }
+
+#define auto_init_recursive_mutex(name) static recursive_mutex_t name = {0}
@@ -0,0 +1,90 @@
+/*
+    ComFrame / Com hot path: parsing, dispatch and answer of a frame must not allocate heap
+    (fixed inline buffers of ComFrame, queued answers in the TX ring buffer)
+*/
+#include <unity.h>
+#include <Com.hpp>
+#include <AllocCounter.hpp>
+#include <MockStream.hpp>
+#include <ComTestFrames.hpp>
+
+#define TEST_FRAMES     1000
+
+class EchoCOM : public ComModule {
+public:
+    EchoCOM() : ComModule(COM_TEST_MODULE) {
+        registerCommand(COM_TEST_COMMAND, [](ComFrame * pFrame) { return true; });
+    }
+};
+
+static ComDispatch dispatch;
+static EchoCOM     echo;
+static MockStream  stream;
+static Com         link("", &dispatch);     // name "" .. no dump registration
+
+// feed the request count times and run Com::loop until all frames are dispatched .. returns the allocations
+static unsigned long runFrames(const uint8_t * pRequest, size_t length, uint32_t count) {
+    uint32_t dispatched = link.getStats().framesDispatched;
+    unsigned long start = allocCount;
+    for (uint32_t i = 0; i < count; i++) {
+        stream.feed(pRequest, length);
+        while ((stream.available() > 0) || (link.getStats().framesDispatched < dispatched + i + 1)) {
+            link.loop(millis());
+        }
+    }
+    return allocCount - start;
+}
+
+void setUp() {
+    stream.tx.clear();
+}
+
+void tearDown() {}
+
+void test_ascii_frame_without_allocation() {
+    uint8_t request[128];
+    size_t length = comTestAsciiRequest(request, sizeof(request));
+
+    runFrames(request, length, 1);                  // warm up (first answer, capture buffer)
+    TEST_ASSERT_TRUE(stream.tx.find("A:E0@4711,echo,0x12345678,0x3E8,0xFFFFFFFF,0xAB,\"" COM_TEST_STR "\"#OK-#") != std::string::npos);
+    stream.capture = false;
+    unsigned long allocs = runFrames(request, length, TEST_FRAMES);
+    stream.capture = true;
+    TEST_ASSERT_EQUAL_UINT32(0, allocs);
+}
+
+void test_binary_frame_without_allocation() {
+    uint8_t request[128];
+    size_t length = comTestBinaryRequest(request, sizeof(request));
+
+    uint32_t received = link.getStats().framesReceived;
+    runFrames(request, length, 1);
+    TEST_ASSERT_EQUAL_UINT32(received + 1, link.getStats().framesReceived);
+    stream.capture = false;
+    unsigned long allocs = runFrames(request, length, TEST_FRAMES);
+    stream.capture = true;
+    TEST_ASSERT_EQUAL_UINT32(0, allocs);
+}
+
+void test_frame_reset_without_allocation() {
+    ComFrame frame;
+    frame.command = "a command name";
+    frame.cfg.str = "a long text parameter, longer than any small string buffer of the library";
+    frame.res = "";
+    unsigned long start = allocCount;
+    for (uint32_t i = 0; i < TEST_FRAMES; i++) {
+        frame.reset();
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, allocCount - start);
+}
+
+int main() {
+    dispatch.registerModule(&echo);
+    link.begin(&stream, "");
+
+    UNITY_BEGIN();
+    RUN_TEST(test_ascii_frame_without_allocation);
+    RUN_TEST(test_binary_frame_without_allocation);
+    RUN_TEST(test_frame_reset_without_allocation);
+    return UNITY_END();
+}
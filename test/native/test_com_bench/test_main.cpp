@@ -0,0 +1,100 @@
+/*
+    COM throughput benchmark on the host (pio test -e native -f native/test_com_bench -v)
+
+    synthetic frames are fed through a memory stream into Com::loop, parsed, dispatched to an echo module
+    and answered. Reported per mode (ASCII / binary): frames/s, rx/tx bytes/s, latency percentiles of one
+    frame (feed until dispatched) and heap allocations per frame.
+    The numbers compare parser changes on one PC, they are not the timing of the target.
+*/
+#include <unity.h>
+#include <Com.hpp>
+#include <AllocCounter.hpp>
+#include <MockStream.hpp>
+#include <ComTestFrames.hpp>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+#ifndef COM_BENCH_FRAMES
+#define COM_BENCH_FRAMES    1000000
+#endif
+
+class EchoCOM : public ComModule {
+public:
+    EchoCOM() : ComModule(COM_TEST_MODULE) {
+        registerCommand(COM_TEST_COMMAND, [](ComFrame * pFrame) { return true; });
+    }
+};
+
+static ComDispatch dispatch;
+static EchoCOM     echo;
+static MockStream  stream;
+static Com         link("", &dispatch);     // name "" .. no dump registration
+static std::vector<uint32_t> latency;       // ns per frame
+
+static void bench(const char * mode, const uint8_t * pRequest, size_t length) {
+    typedef std::chrono::steady_clock Clock;
+
+    ComStats start = link.getStats();
+    uint64_t txStart = stream.txBytes;
+    stream.capture = false;
+    stream.feed(pRequest, length);
+
+    unsigned long allocStart = allocCount;
+    Clock::time_point t0 = Clock::now();
+    uint32_t done = 0;
+    for (uint32_t i = 0; i < COM_BENCH_FRAMES; i++) {
+        Clock::time_point f0 = Clock::now();
+        stream.feed();
+        while (link.getStats().framesDispatched <= start.framesDispatched + i) {
+            if ((stream.available() == 0) && (link.getStats().framesReceived <= start.framesReceived + i)) {
+                break;          // frame not accepted by the parser
+            }
+            link.loop(millis());
+        }
+        latency[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - f0).count();
+        if (link.getStats().framesDispatched <= start.framesDispatched + i) break;
+        done++;
+    }
+    double duration = std::chrono::duration<double>(Clock::now() - t0).count();
+    unsigned long allocs = allocCount - allocStart;
+
+    TEST_ASSERT_EQUAL_UINT32(COM_BENCH_FRAMES, done);
+
+    std::sort(latency.begin(), latency.begin() + done);
+    const ComStats & stats = link.getStats();
+    printf("COM bench %s: %u frames of %u bytes in %.3f s\n", mode, (unsigned)done, (unsigned)length, duration);
+    printf("  frames/s:    %.0f\n", done / duration);
+    printf("  rx bytes/s:  %.0f\n", (stats.bytesReceived - start.bytesReceived) / duration);
+    printf("  tx bytes/s:  %.0f\n", (stream.txBytes - txStart) / duration);
+    printf("  latency [ns] p50: %u p90: %u p99: %u p99.9: %u max: %u\n",
+           latency[done / 2], latency[done * 9 / 10], latency[done * 99 / 100], latency[done * 999 / 1000], latency[done - 1]);
+    printf("  heap allocations per frame: %.3f\n", (double)allocs / done);
+    printf("  frames dropped: %u\n", (unsigned)(stats.framesDropped - start.framesDropped));
+
+    TEST_ASSERT_EQUAL_UINT32(0, allocs);
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_bench_ascii() {
+    uint8_t request[128];
+    bench("ASCII", request, comTestAsciiRequest(request, sizeof(request)));
+}
+
+void test_bench_binary() {
+    uint8_t request[128];
+    bench("binary", request, comTestBinaryRequest(request, sizeof(request)));
+}
+
+int main() {
+    dispatch.registerModule(&echo);
+    link.begin(&stream, "");
+    latency.resize(COM_BENCH_FRAMES);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_bench_ascii);
+    RUN_TEST(test_bench_binary);
+    return UNITY_END();
+}
@@ -0,0 +1,77 @@
+/*
+    COM transmit path: a port that takes no bytes (host closed USB CDC) must not block Com::loop,
+    an answer bigger than the TX queue is cut with an error answer
+*/
+#include <unity.h>
+#include <Com.hpp>
+#include <MockStream.hpp>
+#include <ComTestFrames.hpp>
+
+#define TEST_ANSWER_LENGTH  (3 * (2 * COM_FRAME_MAX_DATA_LENGTH + COM_TX_TEXT_RESERVE))
+
+class StreamCOM : public ComModule {
+public:
+    StreamCOM() : ComModule(COM_TEST_MODULE) {
+        registerCommand(COM_TEST_COMMAND, [](ComFrame * pFrame) {
+            for (uint32_t i = 0; i < TEST_ANSWER_LENGTH / 10; i++) {
+                pFrame->out->print("0123456789");
+            }
+            return true;
+        });
+    }
+};
+
+static ComDispatch dispatch;
+static StreamCOM   streamer;
+static MockStream  stream;
+static Com         link("", &dispatch);     // name "" .. no dump registration
+
+// feed one request and run Com::loop until it is dispatched .. must return even if the port is closed
+static void runFrame() {
+    uint8_t request[128];
+    size_t length = comTestAsciiRequest(request, sizeof(request));
+    uint32_t dispatched = link.getStats().framesDispatched;
+    stream.feed(request, length);
+    while ((stream.available() > 0) || (link.getStats().framesDispatched == dispatched)) {
+        link.loop(millis());
+    }
+}
+
+void setUp() {
+    stream.tx.clear();
+    stream.closed = false;
+}
+
+void tearDown() {
+    // empty the TX queue for the next test
+    for (int i = 0; i < 10; i++) {
+        link.loop(millis());
+    }
+}
+
+void test_closed_port_does_not_block() {
+    uint32_t truncated = link.getStats().txTruncated;
+    stream.closed = true;
+    runFrame();
+    TEST_ASSERT_TRUE(link.getStats().txTruncated > truncated);
+    TEST_ASSERT_EQUAL_UINT32(0, stream.tx.length());
+}
+
+void test_streamed_answer_is_sent_completely() {
+    runFrame();
+    for (int i = 0; i < 10; i++) {
+        link.loop(millis());
+    }
+    TEST_ASSERT_TRUE(stream.tx.find("#OK-") != std::string::npos);
+    TEST_ASSERT_TRUE(stream.tx.length() > TEST_ANSWER_LENGTH);
+}
+
+int main() {
+    dispatch.registerModule(&streamer);
+    link.begin(&stream, "");
+
+    UNITY_BEGIN();
+    RUN_TEST(test_closed_port_does_not_block);
+    RUN_TEST(test_streamed_answer_is_sent_completely);
+    return UNITY_END();
+}